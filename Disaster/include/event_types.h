@@ -0,0 +1,229 @@
+#ifndef EVENT_TYPES_H
+#define EVENT_TYPES_H
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+// ==================== Event Types ====================
+// One list drives everything about a type: the feed code it's interned from,
+// its display name, the two-letter code packed LoRa frames use (keep those
+// unique - the "codes" bot command is their legend), the alert level it gets
+// when the feed has no opinion, and its colour. Feeds' own spellings map onto
+// the same types via the alias list. Parsing hashes the code once into a
+// table laid out at compile time; after that an event's type is a byte and
+// no string is ever compared.
+//
+// The Colour column names TFT_eSPI colours. Only main.cpp expands it, so
+// this header builds without the display library (test/test_event_types).
+
+//      Type       Code         Name        Mesh  Level  Colour
+#define EVENT_TYPES(X) \
+    X(Alert,     "ALERT",     "ALERT",     "AL", 1, TFT_WHITE)       \
+    X(Quake,     "EQ",        "QUAKE",     "EQ", 1, TFT_YELLOW)      \
+    X(Volcano,   "VO",        "VOLCANO",   "VO", 1, TFT_ORANGE)      \
+    X(Slide,     "landslide", "SLIDE",     "LS", 1, TFT_BROWN)       \
+    X(Tornado,   "TORNADO",   "TORNADO",   "TO", 2, TFT_MAGENTA)     \
+    X(Tsunami,   "TSUNAMI",   "TSUNAMI",   "TS", 2, TFT_CYAN)        \
+    X(Cyclone,   "TC",        "CYCLONE",   "TC", 1, TFT_SKYBLUE)     \
+    X(Flood,     "FL",        "FLOOD",     "FL", 1, TFT_BLUE)        \
+    X(Drought,   "DR",        "DROUGHT",   "DR", 1, TFT_GOLD)        \
+    X(Storm,     "STORM",     "STORM",     "ST", 1, TFT_SILVER)      \
+    X(Blizzard,  "SNOW",      "BLIZZARD",  "BZ", 1, TFT_WHITE)       \
+    X(Snow,      "snow",      "SNOW",      "SN", 1, TFT_WHITE)       \
+    X(Iceberg,   "iceberg",   "ICEBERG",   "IB", 1, TFT_CYAN)        \
+    X(Weather,   "WEATHER",   "WEATHER",   "WX", 1, TFT_LIGHTGREY)   \
+    X(Extreme,   "EXTREME",   "EXTREME",   "XW", 2, TFT_RED)         \
+    X(Wildfire,  "WF",        "WILDFIRE",  "WF", 1, TFT_ORANGE)      \
+    X(Fire,      "fire",      "FIRE",      "FI", 1, TFT_ORANGE)      \
+    X(Solar,     "SOLAR",     "SOLAR",     "SO", 1, TFT_YELLOW)      \
+    X(Geomag,    "GEOMAG",    "GEOMAG",    "GM", 1, TFT_GREENYELLOW) \
+    X(Radio,     "RADIO",     "RADIO",     "RB", 1, TFT_VIOLET)      \
+    X(Flare,     "FLARE",     "FLARE",     "FR", 1, TFT_YELLOW)      \
+    X(Cme,       "CME",       "CME",       "CM", 1, TFT_PINK)        \
+    X(War,       "WAR",       "WAR",       "WR", 2, TFT_RED)         \
+    X(Defcon,    "DEFCON",    "DEFCON",    "DC", 2, TFT_RED)         \
+    X(Nuke,      "NUKE",      "NUKE",      "NK", 2, TFT_RED)         \
+    X(Military,  "MILITARY",  "MILITARY",  "MI", 1, TFT_RED)         \
+    X(Conflict,  "CONFLICT",  "CONFLICT",  "CF", 1, TFT_RED)         \
+    X(Terror,    "TERROR",    "TERROR",    "TE", 2, TFT_RED)         \
+    X(Emergency, "EMERGENCY", "EMERGENCY", "EM", 2, TFT_RED)         \
+    X(Epidemic,  "EPIDEMIC",  "EPIDEMIC",  "EP", 1, TFT_GREEN)       \
+    X(Pandemic,  "PANDEMIC",  "PANDEMIC",  "PD", 2, TFT_GREEN)       \
+    X(Outbreak,  "OUTBREAK",  "OUTBREAK",  "OB", 1, TFT_GREEN)       \
+    X(Cyber,     "CYBER",     "CYBER",     "CY", 1, TFT_GREENYELLOW) \
+    X(Plane,     "PLANE",     "PLANE",     "PL", 1, TFT_LIGHTGREY)   \
+    X(Ship,      "SHIP",      "SHIP",      "SH", 1, TFT_LIGHTGREY)   \
+    X(Train,     "TRAIN",     "TRAIN",     "TN", 1, TFT_LIGHTGREY)
+
+// Other spellings feeds use - EONET category ids among them
+#define EVENT_TYPE_ALIASES(A) \
+    A("volcano",      Volcano)  \
+    A("volcanoes",    Volcano)  \
+    A("landslides",   Slide)    \
+    A("flood",        Flood)    \
+    A("floods",       Flood)    \
+    A("drought",      Drought)  \
+    A("storm",        Storm)    \
+    A("severeStorm",  Storm)    \
+    A("severeStorms", Storm)    \
+    A("seaLakeIce",   Iceberg)  \
+    A("wildfire",     Fire)     \
+    A("wildfires",    Fire)     \
+    A("earthquakes",  Quake)
+
+enum class EventType : uint8_t {
+#define X(type, code, name, mesh, level, color) type,
+    EVENT_TYPES(X)
+#undef X
+};
+
+struct EventTypeInfo {
+    const char* code;
+    const char* name;
+    const char* mesh;
+    uint8_t     alertLevel;
+};
+
+static constexpr EventTypeInfo EVENT_TYPE_INFO[] = {
+#define X(type, code, name, mesh, level, color) { code, name, mesh, level },
+    EVENT_TYPES(X)
+#undef X
+};
+
+struct EventCode {
+    const char* code;
+    EventType   type;
+};
+
+static constexpr EventCode EVENT_CODES[] = {
+#define X(type, code, name, mesh, level, color) { code, EventType::type },
+    EVENT_TYPES(X)
+#undef X
+#define A(code, type) { code, EventType::type },
+    EVENT_TYPE_ALIASES(A)
+#undef A
+};
+#define EVENT_CODE_COUNT  ((int)(sizeof(EVENT_CODES) / sizeof(EVENT_CODES[0])))
+
+// FNV-1a with the offset basis nudged until every code gets a slot of its own.
+// Adding a code may need a new seed - the static_assert below says so.
+#define EVENT_HASH_SEED   2166136371UL
+#define EVENT_HASH_SLOTS  256        // Slot = top 8 bits of the hash
+
+constexpr uint32_t eventCodeHash(const char* s, uint32_t h = EVENT_HASH_SEED) {
+    return *s ? eventCodeHash(s + 1, (h ^ (uint8_t)*s) * 16777619UL) : h;
+}
+
+constexpr int eventCodeSlot(const char* s) {
+    return eventCodeHash(s) >> 24;
+}
+
+// First code hashing to slot, -1 = none
+constexpr int eventCodeAt(int slot, int i = 0) {
+    return i == EVENT_CODE_COUNT ? -1
+         : eventCodeSlot(EVENT_CODES[i].code) == slot ? i
+         : eventCodeAt(slot, i + 1);
+}
+
+// Every code is the first in its slot - no two share one
+constexpr bool eventCodesCollisionFree(int i = 0) {
+    return i == EVENT_CODE_COUNT ||
+           (eventCodeAt(eventCodeSlot(EVENT_CODES[i].code)) == i && eventCodesCollisionFree(i + 1));
+}
+static_assert(eventCodesCollisionFree(), "Two event codes share a hash slot - change EVENT_HASH_SEED");
+static_assert(EVENT_CODE_COUNT < 128, "Slot table holds int8_t code indexes");
+
+// Slot -> index into EVENT_CODES, built by the compiler
+template<int... I> struct EventSlotSeq {};
+template<int N, int... I> struct MakeEventSlotSeq : MakeEventSlotSeq<N - 1, N - 1, I...> {};
+template<int... I> struct MakeEventSlotSeq<0, I...> { typedef EventSlotSeq<I...> type; };
+
+struct EventSlotTable {
+    int8_t code[EVENT_HASH_SLOTS];
+};
+
+template<int... I>
+constexpr EventSlotTable buildEventSlots(EventSlotSeq<I...>) {
+    return {{ (int8_t)eventCodeAt(I)... }};
+}
+
+static constexpr EventSlotTable EVENT_SLOTS =
+    buildEventSlots(MakeEventSlotSeq<EVENT_HASH_SLOTS>::type());
+
+// Feed code -> type: one hash, one compare. Unknown codes are plain alerts.
+inline EventType parseEventType(const char* code) {
+    if (!code || !*code) return EventType::Alert;
+    int i = EVENT_SLOTS.code[eventCodeSlot(code)];
+    if (i < 0 || strcmp(EVENT_CODES[i].code, code) != 0) return EventType::Alert;
+    return EVENT_CODES[i].type;
+}
+
+// Words people type that no feed sends
+static constexpr EventCode EVENT_TYPE_WORDS[] = {
+    { "earthquake", EventType::Quake },
+    { "eruption",   EventType::Volcano },
+    { "hurricane",  EventType::Cyclone },
+    { "typhoon",    EventType::Cyclone },
+};
+
+static inline bool eventWordIs(const char* known, const char* word, size_t len) {
+    return strlen(known) == len && strncasecmp(known, word, len) == 0;
+}
+
+// What a person typed -> type, for bot commands rather than feeds. Looser than
+// parseEventType(): any case; display names, mesh codes, feed codes and the
+// words above all count, with or without a plural 's'. Display names are
+// tried first, so "snow" is SNOW, not the NWS code for BLIZZARD.
+// A linear scan. Returns false when nothing matches.
+inline bool findEventType(const char* word, EventType* out) {
+    size_t len = word ? strlen(word) : 0;
+    const int infoCount = sizeof(EVENT_TYPE_INFO) / sizeof(EVENT_TYPE_INFO[0]);
+    const int wordCount = sizeof(EVENT_TYPE_WORDS) / sizeof(EVENT_TYPE_WORDS[0]);
+
+    for (int plural = 0; plural < 2 && len > 1; plural++) {
+        if (plural) {
+            if (word[len - 1] != 's' && word[len - 1] != 'S') break;
+            len--;
+        }
+        for (int t = 0; t < infoCount; t++) {
+            if (eventWordIs(EVENT_TYPE_INFO[t].name, word, len) ||
+                eventWordIs(EVENT_TYPE_INFO[t].mesh, word, len)) {
+                *out = (EventType)t;
+                return true;
+            }
+        }
+        for (int i = 0; i < EVENT_CODE_COUNT; i++) {
+            if (eventWordIs(EVENT_CODES[i].code, word, len)) {
+                *out = EVENT_CODES[i].type;
+                return true;
+            }
+        }
+        for (int i = 0; i < wordCount; i++) {
+            if (eventWordIs(EVENT_TYPE_WORDS[i].code, word, len)) {
+                *out = EVENT_TYPE_WORDS[i].type;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Event type display names
+inline const char* getEventTypeName(EventType type) {
+    return EVENT_TYPE_INFO[(uint8_t)type].name;
+}
+
+inline const char* getEventTypeCode(EventType type) {
+    return EVENT_TYPE_INFO[(uint8_t)type].code;
+}
+
+inline const char* getEventTypeMeshCode(EventType type) {
+    return EVENT_TYPE_INFO[(uint8_t)type].mesh;
+}
+
+inline uint8_t getEventTypeAlertLevel(EventType type) {
+    return EVENT_TYPE_INFO[(uint8_t)type].alertLevel;
+}
+
+#endif // EVENT_TYPES_H
@@ -0,0 +1,147 @@
+#ifndef LORA_FRAME_H
+#define LORA_FRAME_H
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "event_types.h"
+
+// ==================== LoRa Frames ====================
+// One alert alone goes out readable: "QUAKE M6.1 45 km SSW of Tobelo, Indonesia".
+// Several share one frame: "⚠3 EQ61 Tobelo,ID;WF C CA,US;TS TO" - mesh type
+// code, magnitude as two digits (M6.1 -> 61), region shortened by the
+// dictionary below. "e844 codes" sends the type legend.
+
+#define LORA_PAYLOAD_MAX        200         // Meshtastic text payload, with margin
+#define LORA_REGION_MAX         18          // Per alert in a packed frame
+
+// Alert processing produces, the mesh scheduler consumes. Kept as fields,
+// not text, so the sender can pick the readable or the packed form. The
+// location is a handle into the owner's string store; the formatters below
+// are given the text.
+struct LoraMessage {
+    EventType type;
+    uint8_t   location;     // Location handle, 0 = none
+    int16_t   magnitude10;  // 0 = none
+    uint32_t  queuedAt;     // millis()
+};
+
+struct RegionAbbrev {
+    const char* from;
+    const char* to;
+};
+
+// Whole words, any case (EMSC shouts); first match wins, so longer names go first
+static const RegionAbbrev REGION_ABBREVS[] = {
+    { "United States", "US" },  { "Papua New Guinea", "PNG" }, { "New Zealand", "NZ" },
+    { "Solomon Islands", "SB" }, { "Philippines", "PH" },      { "Indonesia", "ID" },
+    { "Japan", "JP" },          { "Taiwan", "TW" },            { "China", "CN" },
+    { "Russia", "RU" },         { "Kamchatka", "Kam" },        { "Alaska", "AK" },
+    { "Hawaii", "HI" },         { "California", "CA" },        { "Canada", "CAN" },
+    { "Mexico", "MX" },         { "Guatemala", "GT" },         { "Colombia", "CO" },
+    { "Ecuador", "EC" },        { "Peru", "PE" },              { "Chile", "CL" },
+    { "Argentina", "AR" },      { "Iceland", "IS" },           { "Italy", "IT" },
+    { "Greece", "GR" },         { "Turkey", "TR" },            { "Turkiye", "TR" },
+    { "Iran", "IR" },           { "India", "IN" },             { "Australia", "AU" },
+    { "Vanuatu", "VU" },        { "Fiji", "FJ" },              { "Tonga", "TO" },
+    { "Northern", "N" },        { "Southern", "S" },           { "Eastern", "E" },
+    { "Western", "W" },         { "Central", "C" },            { "North", "N" },
+    { "South", "S" },           { "East", "E" },               { "West", "W" },
+    { "Islands", "Is" },        { "Island", "I" },             { "Ridge", "Rdg" },
+    { "Peninsula", "Pen" },     { "County", "Co" },            { "Province", "Prov" },
+    { "Mount", "Mt" },          { "Ocean", "Oc" },             { "Off the coast", "off" },
+    { "coast", "cst" },         { "Near", "nr" },              { "region", "" },
+    { "of", "" },
+};
+
+// "45 km SSW of Tobelo, Indonesia" -> "Tobelo,ID"
+inline void compactRegion(const char* loc, char* out, size_t cap) {
+    // USGS places start with a distance and bearing - the town is enough
+    if (isdigit((uint8_t)loc[0])) {
+        const char* of = strstr(loc, " of ");
+        if (of) loc = of + 4;
+    }
+    
+    size_t n = 0;
+    const char* p = loc;
+    while (*p && n + 1 < cap) {
+        bool wordStart = (p == loc || !isalpha((uint8_t)p[-1]));
+        const RegionAbbrev* hit = NULL;
+        if (wordStart && isalpha((uint8_t)*p)) {
+            for (size_t i = 0; i < sizeof(REGION_ABBREVS) / sizeof(REGION_ABBREVS[0]); i++) {
+                size_t len = strlen(REGION_ABBREVS[i].from);
+                if (strncasecmp(p, REGION_ABBREVS[i].from, len) == 0 && !isalpha((uint8_t)p[len])) {
+                    hit = &REGION_ABBREVS[i];
+                    p += len;
+                    break;
+                }
+            }
+        }
+        if (hit) {
+            for (const char* t = hit->to; *t && n + 1 < cap; t++) out[n++] = *t;
+            continue;
+        }
+        
+        // No doubled, leading or after-comma spaces; ';' is our separator
+        char c = *p++;
+        if (c == ';') c = ',';
+        if (c == ' ' && (n == 0 || out[n - 1] == ' ' || out[n - 1] == ',')) continue;
+        out[n++] = c;
+    }
+    while (n > 0 && (out[n - 1] == ' ' || out[n - 1] == ',')) n--;
+    out[n] = '\0';
+}
+
+inline void formatLoraReadable(const LoraMessage& m, const char* location, char* out, size_t cap) {
+    const char* name = getEventTypeName(m.type);
+    if (m.magnitude10 > 0) {
+        snprintf(out, cap, "%s M%.1f %s", name, m.magnitude10 / 10.0f, location);
+    } else {
+        snprintf(out, cap, "%s %s", name, location);
+    }
+}
+
+inline void formatLoraPacked(const LoraMessage& m, const char* location, char* out, size_t cap) {
+    char region[LORA_REGION_MAX + 1];
+    compactRegion(location, region, sizeof(region));
+    int len = snprintf(out, cap, "%s", getEventTypeMeshCode(m.type));
+    if (m.magnitude10 > 0) {
+        len += snprintf(out + len, cap - len, "%02d", m.magnitude10 < 99 ? (int)m.magnitude10 : 99);
+    }
+    if (region[0]) snprintf(out + len, cap - len, " %s", region);
+}
+
+// The next packet, built from the front of a queue (anything with size() and
+// peek(i), oldest first) without taking anything off. locate(message) gives
+// a message's location text. Returns how many alerts it carries.
+template <typename Queue, typename Locate>
+int packLoraFrame(const Queue& q, Locate locate, char* packet, size_t cap) {
+    int waiting = q.size();
+    if (waiting == 0) return 0;
+    if (waiting == 1) {
+        formatLoraReadable(*q.peek(), locate(*q.peek()), packet, cap);
+        return 1;
+    }
+    
+    // Header holds the count, so fill the body first
+    char body[LORA_PAYLOAD_MAX + 1];
+    char entry[8 + LORA_REGION_MAX];
+    const size_t header = 6;            // "⚠" is 3 bytes, then up to two digits and a space
+    const size_t limit = cap - 1 < LORA_PAYLOAD_MAX ? cap - 1 : LORA_PAYLOAD_MAX;
+    size_t len = 0;
+    int count = 0;
+    for (int i = 0; i < waiting; i++) {
+        formatLoraPacked(*q.peek(i), locate(*q.peek(i)), entry, sizeof(entry));
+        size_t need = strlen(entry) + (count ? 1 : 0);
+        if (header + len + need > limit) break;
+        len += snprintf(body + len, sizeof(body) - len, "%s%s", count ? ";" : "", entry);
+        count++;
+    }
+    snprintf(packet, cap, "⚠%d %s", count, body);
+    return count;
+}
+
+#endif // LORA_FRAME_H
@@ -0,0 +1,113 @@
+#ifndef SEEN_TABLE_H
+#define SEEN_TABLE_H
+
+#include <stdint.h>
+
+// ==================== Seen-ID Table ====================
+// Open-addressing (linear probing) set of event ID fingerprints. Each slot:
+// 8-bit expiry stamp | 24-bit fingerprint, 0 = empty. The stamp counts time
+// units mod 256, 0 = never expires; the caller decides what a unit is and
+// passes the current one in as `now` (-1 = clock not set, nothing expires).
+//
+// 24 bits keep a false positive - a new event taken for one already seen -
+// to ~1 in 50000 at a few hundred live IDs; 16 bits would be ~1 in 200,
+// which is a missed alert every few days. test/test_seen_table measures both.
+
+#define SEEN_FP_MASK  0x00FFFFFFUL
+
+template <int SLOTS>
+struct SeenTable {
+    uint32_t slots[SLOTS];
+    int      count;
+
+    void clear() {
+        for (int i = 0; i < SLOTS; i++) slots[i] = 0;
+        count = 0;
+    }
+
+    // 64-bit ID hash folded to 24 bits, never 0
+    static uint32_t fingerprint(uint64_t h) {
+        uint32_t fp = (uint32_t)(h ^ (h >> 32)) & SEEN_FP_MASK;
+        return fp ? fp : 1;
+    }
+
+    static bool expired(uint32_t slot, int now) {
+        uint8_t expiry = slot >> 24;
+        return expiry && now >= 0 && (int8_t)(now - expiry) >= 0;
+    }
+
+    // Backward-shift delete - keeps every probe chain intact without tombstones
+    void remove(int i) {
+        int j = i;
+        while (true) {
+            j = (j + 1) % SLOTS;
+            if (!slots[j]) break;
+            int home = (slots[j] & SEEN_FP_MASK) % SLOTS;
+            bool stays = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+            if (!stays) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = 0;
+        count--;
+    }
+
+    // Slot holding fp, or the empty slot where it would go.
+    // Expired entries met along the way are dropped (lazy expiry).
+    int probe(uint32_t fp, int now) {
+        int i = fp % SLOTS;
+        while (slots[i]) {
+            if (expired(slots[i], now)) {
+                remove(i);   // Something else may have shifted into i
+                continue;
+            }
+            if ((slots[i] & SEEN_FP_MASK) == fp) break;
+            i = (i + 1) % SLOTS;
+        }
+        return i;
+    }
+
+    bool contains(uint64_t idHash, int now) {
+        return slots[probe(fingerprint(idHash), now)] != 0;
+    }
+
+    // Insert or overwrite. The caller keeps the load down - see sweep() and
+    // evictSoonest(); a full table refuses a new fingerprint.
+    bool set(uint32_t slot, int now) {
+        int i = probe(slot & SEEN_FP_MASK, now);
+        if (!slots[i]) {
+            if (count >= SLOTS - 1) return false;   // Keep one empty to end probes
+            count++;
+        }
+        slots[i] = slot;
+        return true;
+    }
+
+    // Drop everything expired. Returns how many went.
+    int sweep(int now) {
+        int before = count;
+        for (int i = 0; i < SLOTS; ) {
+            if (slots[i] && expired(slots[i], now)) remove(i);
+            else i++;
+        }
+        return before - count;
+    }
+
+    // Drop the entry that would have expired soonest (undated ones first)
+    void evictSoonest(int now) {
+        int victim = -1, soonest = 256;
+        for (int i = 0; i < SLOTS; i++) {
+            if (!slots[i]) continue;
+            uint8_t expiry = slots[i] >> 24;
+            int left = (expiry && now >= 0) ? (int8_t)(expiry - now) : -1;
+            if (left < soonest) {
+                soonest = left;
+                victim = i;
+            }
+        }
+        if (victim >= 0) remove(victim);
+    }
+};
+
+#endif // SEEN_TABLE_H
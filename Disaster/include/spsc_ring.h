@@ -0,0 +1,85 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// ==================== SPSC Ring Buffer ====================
+// Fixed-size queue between exactly one producer and one consumer, which may
+// be different FreeRTOS tasks (or cores) - no mutex, no allocation.
+//
+// The producer only writes tail_, the consumer only writes head_. A slot is
+// filled before tail_ is published (release) and read before head_ is
+// published, so each side sees the other's data once it sees the index.
+// One slot is always left empty to tell full from empty, which keeps any N
+// working, not just powers of two.
+//
+// Producer side: push(), full().  Consumer side: pop(), peek(), drop(), clear().
+// size()/empty() are safe from either side but only a snapshot.
+
+template <typename T, size_t N>
+class SpscRing {
+public:
+    static_assert(N > 0, "SpscRing needs at least one slot");
+
+    SpscRing() : head_(0), tail_(0) {}
+
+    size_t capacity() const { return N; }
+
+    bool push(const T& item) {
+        uint32_t t = tail_.load(std::memory_order_relaxed);
+        uint32_t next = advance(t);
+        if (next == head_.load(std::memory_order_acquire)) return false;  // Full
+        buf_[t] = item;
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_.load(std::memory_order_acquire)) return false;     // Empty
+        out = buf_[h];
+        head_.store(advance(h), std::memory_order_release);
+        return true;
+    }
+
+    // i-th oldest entry, or NULL - valid until the consumer pops it
+    const T* peek(size_t i = 0) const {
+        if (i >= size()) return NULL;
+        return &buf_[(head_.load(std::memory_order_relaxed) + i) % SLOTS];
+    }
+
+    // Discard the oldest entry without copying it out
+    bool drop() {
+        uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_.load(std::memory_order_acquire)) return false;
+        head_.store(advance(h), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - empties whatever the producer has published so far
+    void clear() {
+        head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        uint32_t h = head_.load(std::memory_order_acquire);
+        uint32_t t = tail_.load(std::memory_order_acquire);
+        return (t + SLOTS - h) % SLOTS;
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const  { return size() == N; }
+
+private:
+    static const uint32_t SLOTS = N + 1;
+
+    static uint32_t advance(uint32_t i) { return i + 1 == SLOTS ? 0 : i + 1; }
+
+    T buf_[SLOTS];
+    std::atomic<uint32_t> head_;    // Next slot to read - consumer owned
+    std::atomic<uint32_t> tail_;    // Next slot to write - producer owned
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,84 @@
+#ifndef WORLD_MAP_H
+#define WORLD_MAP_H
+
+#include <stdint.h>
+
+// ==================== World Land Mask ====================
+// Equirectangular, 1.5 degrees per pixel: row 0 is 90N, column 0 is 180W.
+// Each row is a list of run lengths alternating sea, land, sea... and
+// always starts with sea (0 when the row starts on land); a row's runs sum
+// to WORLD_MAP_W. Coastlines are simplified outlines, good enough to place
+// markers on. Being const it stays in flash and is read through the cache.
+
+#define WORLD_MAP_W  240
+#define WORLD_MAP_H  120
+
+static const uint8_t worldMapRuns[1033] = {
+    240, 240, 240, 240, 96, 4, 140, 59, 19, 3, 26, 133, 56, 18, 1, 32,
+    133, 57, 13, 2, 36, 20, 7, 105, 58, 9, 6, 35, 21, 3, 56, 2,
+    50, 41, 12, 26, 29, 51, 4, 20, 9, 48, 39, 4, 4, 8, 27, 25,
+    50, 3, 16, 19, 45, 45, 2, 6, 3, 7, 5, 15, 24, 49, 2, 10,
+    35, 37, 15, 2, 24, 10, 11, 9, 13, 22, 49, 1, 11, 40, 1, 13,
+    19, 12, 13, 6, 5, 6, 10, 4, 4, 5, 9, 11, 20, 27, 9, 26,
+    68, 5, 10, 39, 6, 7, 7, 7, 8, 18, 28, 16, 3, 1, 1, 14,
+    1, 74, 9, 55, 6, 8, 7, 12, 32, 18, 2, 91, 9, 55, 5, 9,
+    7, 9, 10, 7, 17, 7, 1, 7, 5, 92, 11, 50, 8, 8, 9, 7,
+    13, 3, 17, 7, 2, 102, 3, 10, 49, 9, 1, 18, 5, 31, 9, 2,
+    102, 4, 11, 9, 4, 34, 10, 5, 16, 3, 31, 9, 3, 99, 6, 13,
+    5, 10, 30, 10, 6, 1, 3, 46, 8, 4, 79, 4, 10, 11, 13, 4,
+    14, 28, 9, 10, 38, 3, 9, 3, 5, 78, 11, 4, 11, 12, 2, 18,
+    29, 6, 12, 37, 3, 7, 1, 1, 3, 3, 78, 12, 5, 11, 33, 32,
+    2, 13, 35, 1, 1, 2, 7, 2, 4, 81, 11, 4, 12, 34, 32, 1,
+    15, 31, 3, 2, 2, 4, 90, 10, 3, 13, 35, 48, 30, 2, 2, 4,
+    2, 91, 10, 1, 15, 36, 46, 1, 1, 32, 1, 4, 93, 26, 38, 39,
+    1, 3, 1, 3, 34, 95, 1, 1, 24, 37, 39, 7, 2, 33, 95, 27,
+    37, 39, 43, 21, 2, 3, 1, 6, 3, 57, 28, 37, 38, 44, 9, 2,
+    9, 6, 6, 3, 57, 3, 2, 24, 37, 36, 41, 8, 5, 2, 3, 7,
+    8, 5, 3, 54, 4, 3, 24, 37, 36, 41, 7, 8, 2, 2, 6, 2,
+    3, 3, 6, 2, 52, 33, 38, 32, 44, 6, 10, 2, 2, 1, 3, 15,
+    3, 44, 1, 5, 7, 2, 25, 38, 32, 44, 6, 14, 2, 2, 15, 3,
+    43, 5, 2, 7, 1, 26, 39, 30, 46, 4, 3, 5, 12, 62, 3, 2,
+    5, 3, 26, 39, 31, 46, 2, 1, 8, 17, 56, 4, 1, 3, 5, 27,
+    41, 27, 47, 12, 17, 56, 7, 1, 1, 1, 30, 42, 25, 47, 15, 6,
+    1, 7, 58, 6, 1, 32, 43, 23, 48, 28, 1, 58, 39, 43, 1, 1,
+    12, 2, 1, 5, 1, 47, 29, 1, 9, 2, 47, 39, 44, 1, 1, 9,
+    10, 2, 45, 30, 2, 9, 2, 46, 39, 45, 1, 1, 8, 11, 1, 43,
+    33, 1, 10, 4, 42, 40, 45, 1, 2, 7, 55, 33, 2, 9, 2, 2,
+    7, 34, 41, 46, 1, 2, 6, 54, 35, 2, 13, 7, 32, 2, 1, 39,
+    50, 5, 10, 4, 40, 36, 1, 14, 6, 14, 1, 14, 45, 50, 5, 5,
+    2, 6, 2, 39, 36, 2, 12, 9, 10, 4, 9, 49, 51, 5, 3, 3,
+    9, 3, 35, 36, 3, 10, 11, 7, 7, 7, 50, 53, 8, 48, 37, 2,
+    8, 13, 6, 8, 8, 9, 1, 39, 58, 6, 45, 37, 2, 7, 14, 5,
+    11, 7, 8, 2, 38, 59, 5, 45, 39, 1, 3, 17, 4, 13, 7, 7,
+    2, 38, 62, 2, 45, 40, 21, 3, 13, 7, 47, 62, 2, 6, 4, 36,
+    39, 4, 1, 16, 3, 15, 4, 10, 2, 36, 63, 3, 3, 10, 32, 43,
+    17, 2, 17, 1, 11, 1, 37, 65, 15, 32, 41, 20, 1, 12, 1, 15,
+    2, 36, 68, 13, 31, 41, 20, 1, 12, 2, 14, 2, 36, 68, 16, 30,
+    4, 6, 28, 32, 1, 2, 2, 8, 2, 41, 68, 18, 40, 25, 34, 1,
+    1, 2, 7, 3, 41, 67, 19, 40, 24, 35, 2, 1, 1, 5, 5, 41,
+    67, 20, 39, 23, 37, 2, 5, 5, 42, 66, 22, 38, 22, 39, 2, 4,
+    4, 3, 2, 38, 67, 23, 37, 20, 40, 3, 3, 4, 3, 1, 7, 2,
+    1, 2, 27, 66, 29, 33, 19, 41, 3, 5, 1, 2, 3, 7, 7, 24,
+    66, 30, 32, 18, 43, 2, 21, 5, 23, 67, 30, 31, 18, 44, 5, 17,
+    6, 22, 67, 30, 32, 17, 48, 2, 16, 4, 2, 1, 21, 68, 28, 33,
+    18, 52, 3, 17, 1, 20, 68, 27, 34, 18, 93, 69, 25, 35, 18, 60,
+    4, 3, 2, 24, 70, 24, 34, 19, 5, 1, 54, 4, 3, 2, 24, 71,
+    23, 34, 18, 5, 3, 49, 8, 3, 3, 23, 72, 22, 34, 17, 4, 4,
+    49, 11, 1, 3, 23, 73, 21, 34, 16, 6, 3, 48, 17, 22, 73, 20,
+    36, 14, 6, 3, 47, 20, 21, 73, 20, 36, 15, 5, 3, 44, 24, 20,
+    73, 18, 39, 14, 5, 3, 44, 25, 19, 73, 16, 41, 13, 7, 1, 45,
+    26, 18, 73, 15, 42, 12, 54, 26, 18, 72, 16, 43, 10, 55, 26, 18,
+    72, 15, 44, 10, 56, 25, 18, 72, 14, 46, 8, 57, 25, 18, 72, 13,
+    47, 7, 58, 7, 5, 12, 19, 72, 13, 47, 5, 60, 4, 9, 1, 1,
+    9, 19, 71, 11, 130, 8, 15, 1, 4, 71, 11, 131, 7, 16, 1, 3,
+    71, 10, 133, 4, 18, 3, 1, 71, 8, 158, 1, 2, 71, 6, 140, 2,
+    16, 2, 3, 71, 6, 140, 2, 15, 2, 4, 71, 6, 155, 2, 6, 70,
+    6, 155, 2, 7, 70, 6, 164, 70, 6, 164, 70, 5, 165, 70, 4, 166,
+    71, 4, 165, 73, 3, 164, 240, 240, 240, 240, 240, 81, 1, 158, 78, 3,
+    159, 76, 4, 97, 35, 28, 74, 5, 70, 72, 19, 72, 6, 59, 89, 14,
+    70, 7, 35, 119, 9, 67, 10, 30, 126, 7, 33, 46, 25, 128, 8, 22,
+    60, 19, 130, 9, 7, 80, 7, 136, 10, 0, 240, 0, 240, 0, 240, 0,
+    240, 0, 240, 0, 240, 0, 240, 0, 240
+};
+
+#endif // WORLD_MAP_H
@@ -5,14 +5,29 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 #include <HTTPClient.h>
-#include <EEPROM.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#if __has_include(<esp32/rom/miniz.h>)
+#include <esp32/rom/miniz.h>  // tinfl lives in ROM - no flash cost
+#else
+#include <rom/miniz.h>
+#endif
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <esp_heap_caps.h>   // DMA-capable strip buffers
 #include <ArduinoJson.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
 #include <esp_task_wdt.h>    // Watchdog
 #include "soc/rtc_cntl_reg.h" // Brown-out detector
+#include "world_map.h"           // Land mask for the map screen
+#include "spsc_ring.h"           // Queues between tasks
+#include "seen_table.h"          // Fingerprint set of seen event IDs
+#include "event_types.h"         // Feed code -> EventType table
+#include "lora_frame.h"          // Readable and packed mesh frames
 
 // display_mesh_chat is defined below in DISPLAY FUNCTIONS section
 
@@ -21,9 +36,12 @@ const char* WIFI_SSID     = "demon";
 const char* WIFI_PASSWORD = "lacasa";
 
 // ==================== TIMING ====================
-#define FETCH_INTERVAL_MS   (5UL * 60UL * 1000UL)
+#define FETCH_INTERVAL_MS   (5UL * 60UL * 1000UL)   // Base poll interval, see FEEDS[]
 #define DISPLAY_DURATION_MS (8UL * 1000UL)
+#define IDLE_REFRESH_MS     5000                    // Status screen readout
+#define IDLE_SWITCH_MS      (60UL * 1000UL)         // Status <-> world map
 #define WIFI_TIMEOUT_MS     30000
+#define HTTP_TIMEOUT_MS     15000
 
 // ==================== TTGO HARDWARE ====================
 TFT_eSPI tft = TFT_eSPI();
@@ -48,44 +66,84 @@ static unsigned long last_garbage_reset = 0;
 static bool uart_healthy = true;
 
 // ==================== API ENDPOINTS ====================
-const char* USGS_URL = "https://earthquake.usgs.gov/earthquakes/feed/v1.0/summary/4.5_day.geojson";
+// USGS and EMSC use the FDSN event query - fetchFeed() appends the order,
+// the time window and the page
+const char* USGS_URL = "https://earthquake.usgs.gov/fdsnws/event/1/query?format=geojson&minmagnitude=4.5&limit=5";
 // EMSC - European Mediterranean Seismological Centre
-const char* EMSC_URL = "https://www.seismicportal.eu/fdsnws/event/1/query?limit=10&minmag=4.5&format=json";
+const char* EMSC_URL = "https://www.seismicportal.eu/fdsnws/event/1/query?format=json&minmag=4.5&limit=5";
 // NASA EONET - Natural events (fires, storms, volcanoes)
 const char* EONET_URL = "https://eonet.gsfc.nasa.gov/api/v3/events?status=open&limit=10";
 // NOAA Space Weather - solar activity
 const char* NOAA_SPACE_URL = "https://services.swpc.noaa.gov/products/noaa-scales.json";
 // NWS Active Alerts - Severe weather (US only) - limited to reduce size
 const char* NWS_ALERTS_URL = "https://api.weather.gov/alerts/active?status=actual&severity=Extreme&limit=5";
+#define NWS_MAX_ALERTS 3   // Stop reading the feed after this many alerts
+// GDACS - Global Disaster Alert and Coordination System (red alerts only)
+const char* GDACS_URL = "https://www.gdacs.org/gdacsapi/api/events/geteventlist/SEARCH?alertlevel=red";
 
 // ==================== LORA TIMING ====================
-#define LORA_SEND_INTERVAL_MS   (60UL * 60UL * 1000UL)  // 1 hour between LoRa sends
-static unsigned long lastLoraSendTime = 0;
-static bool loraHourlyPending = false;  // Flag to indicate we have events to send
-
-// ==================== EEPROM PROTECTION ====================
-#define EEPROM_SIZE    512
-#define EEPROM_MAGIC   0xDA
-#define EEPROM_VERSION 0x02  // Bumped version for new format
-#define MAX_EVENTS     20
-#define ID_LENGTH      24
-
-// *** EEPROM WEAR PROTECTION ***
-#define EEPROM_MIN_SAVE_INTERVAL  30000   // Minimum 30 seconds between saves
-#define EEPROM_MAX_SAVES_PER_HOUR 20      // Max 20 saves per hour
-#define EEPROM_WRITE_COUNT_ADDR   500     // Store write count at end of EEPROM
-#define EEPROM_MAX_LIFETIME_WRITES 100000 // ESP32 EEPROM rated for ~100k writes
-
-static unsigned long last_eeprom_save_time = 0;
-static uint16_t eeprom_saves_this_hour = 0;
+// Everything we put on the mesh is charged to a token bucket of airtime that
+// refills at the duty-cycle rate. Red alerts go out at once, borrowing from
+// the bucket if they have to; orange waits for budget, green only uses what
+// is left above a reserve. Whatever waits gets packed into shared packets.
+// The model covers our own transmissions, not the mesh's rebroadcasts.
+// Frame layout and size limits are in lora_frame.h.
+#define LORA_DUTY_PERMILLE      10          // 1% - the EU868 sub-band limit
+#define LORA_BUCKET_MS          12000L      // Burst allowance, ms of airtime
+#define LORA_GREEN_RESERVE_MS   (LORA_BUCKET_MS / 2)
+#define LORA_TX_OVERHEAD_MS     300         // Preamble + radio/mesh headers (LongFast)
+#define LORA_MS_PER_BYTE        8           // LongFast is ~1 kbps
+#define LORA_TX_GAP_MS          600UL       // Between two of our packets
+#define LORA_MAX_AGE_MS         (6UL * 60UL * 60UL * 1000UL)  // Stale green/orange is dropped
+#define LORA_REFILL_MS          (1000UL / LORA_DUTY_PERMILLE) // Wall time per ms of airtime
+
+static long          loraTokensMs   = LORA_BUCKET_MS;
+static unsigned long loraRefilledAt = 0;
+static unsigned long loraLastTxAt   = 0;
+
+// ==================== STATE SNAPSHOTS ====================
+// Display queue, LoRa queue and feed high-water marks are saved as whole
+// CRC32-checked snapshots in the "state" partition, one per 4KB sector.
+// Each save goes to the sector after the last one, so the previous snapshot
+// is never touched while the new one is written (A/B), and erases rotate
+// through the partition. The loader takes the newest snapshot that checks out.
+#define STATE_PARTITION   "state"
+#define STATE_SUBTYPE     0x42
+#define STATE_SECTOR      4096
+#define STATE_MAGIC       0x57A7E001UL
+#define STATE_VERSION     7
+#define ID_LENGTH         24
+
+// *** SEEN SET - open-addressing table of ID fingerprints (seen_table.h) ***
+// 384 x 4-byte slots = 1.5KB. That is more than the old 20 x 24-char array,
+// but a few hundred IDs won't fit 480 bytes with a usable false-positive rate
+// next to the expiry stamp - see seen_table.h.
+// Expiry counts 4-hour units mod 256 (0 = clock wasn't set, no expiry), so a
+// TTL can be at most ~21 days before the stamp becomes ambiguous.
+#define SEEN_SLOTS       384
+#define SEEN_MAX_LOAD    307     // Past 80% full, evict whatever expires soonest
+#define SEEN_TTL_UNIT_S  (4UL * 3600UL)
+#define SEEN_TTL_MAX_H   500
+
+// *** FLASH WEAR PROTECTION ***
+#define STATE_MIN_SAVE_INTERVAL   30000   // Minimum 30 seconds between saves
+#define STATE_MAX_SAVES_PER_HOUR  20      // Max 20 saves per hour
+#define FLASH_MAX_SECTOR_ERASES   100000  // Flash sectors rated for ~100k erases
+
+// High-water marks of the incremental feeds (FEEDS[0..SLOTS-1])
+#define STATE_HWM_SLOTS           3
+#define HWM_SANE_MIN              1577836800UL  // 2020-01-01 - anything else is garbage
+#define HWM_SANE_MAX              2208988800UL  // 2040-01-01
+
+static unsigned long last_state_save_time = 0;
+static uint16_t state_saves_this_hour = 0;
 static unsigned long hour_start_time = 0;
-static uint32_t total_eeprom_writes = 0;
-static bool eeprom_write_allowed = true;
+static bool state_write_allowed = true;
+bool state_dirty = false;   // Queues or high-water marks changed since the last save
 
 // ==================== MEMORY PROTECTION ====================
 #define MIN_FREE_HEAP       10000   // Minimum 10KB free heap
 #define CRITICAL_FREE_HEAP  5000    // Critical: 5KB - stop operations
-#define MAX_JSON_SIZE       20000   // 20KB - USGS payloads are ~13KB
 
 // ==================== WATCHDOG ====================
 #define WDT_TIMEOUT_SECONDS 30  // Reset if hung for 30 seconds
@@ -94,78 +152,196 @@ static bool eeprom_write_allowed = true;
 #define BUTTON_HOLD_TIME    3000
 #define STACK_MONITOR_INTERVAL 10000
 
-char seenEvents[MAX_EVENTS][ID_LENGTH];
-int  seenCount = 0;
-int  seenIndex = 0;
+SeenTable<SEEN_SLOTS> seen;
+
+// ==================== EVENT TYPES ====================
+// The list and the code -> type table live in event_types.h; the colours stay
+// here with the rest of TFT_eSPI.
+
+static const uint16_t EVENT_TYPE_COLORS[] = {
+#define X(type, code, name, mesh, level, color) color,
+    EVENT_TYPES(X)
+#undef X
+};
+
+uint16_t getEventTypeColor(EventType type) {
+    return EVENT_TYPE_COLORS[(uint8_t)type];
+}
 
 // ==================== QUEUE ====================
+// A feed mapper fills in a FeedEvent - full text, and it only lives on the
+// way from the parser to addToQueue(). What the queue keeps is the packed
+// DisasterEvent: the ID reduced to a 64-bit hash, numbers in fixed point, and
+// the location text shared through the location arena below.
+
+struct FeedEvent {
+    char      id[ID_LENGTH];
+    EventType type;         // Interned from the feed's code by parseEventType()
+    char      location[64];
+    float     magnitude;
+    uint32_t  feedTime;     // Time the feed's incremental query filters on (epoch s), 0 = none
+    uint32_t  originTime;   // When it happened (epoch s), 0 = not a located event
+    float     lat;
+    float     lon;
+    uint8_t   alertLevel;   // 0=green, 1=orange, 2=red
+    uint8_t   source;       // Index into FEEDS[]
+};
+
 struct DisasterEvent {
-    char    id[ID_LENGTH];
-    char    type[12];       // EQ, TC, FL, VO, WF, DR, storm, fire, etc.
-    char    location[64];
-    float   magnitude;
-    uint8_t alertLevel;     // 0=green, 1=orange, 2=red
+    uint64_t  idHash;       // eventIdHash() of the feed's ID
+    int16_t   magnitude10;  // Magnitude x10, 0 = none
+    int16_t   lat100;       // Degrees x100
+    int16_t   lon100;
+    uint8_t   location;     // Location arena handle, 0 = none
+    EventType type;
+    uint8_t   alertLevel;   // 0=green, 1=orange, 2=red
+    uint8_t   source;       // Index into FEEDS[]
+};
+
+#define EVENT_SIZE_BUDGET 24
+static_assert(sizeof(DisasterEvent) <= EVENT_SIZE_BUDGET, "Queued events must stay packed");
+
+// 64-bit FNV-1a - also what the seen set folds its fingerprints from
+uint64_t eventIdHash(const char* id) {
+    uint64_t h = 14695981039346656037ULL;
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// 32-bit FNV-1a - location arena dedup, feed "nothing new" fingerprints
+uint32_t fnv1a32(const char* s) {
+    uint32_t h = 2166136261UL;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+inline float eventMagnitude(const DisasterEvent& e) { return e.magnitude10 / 10.0f; }
+inline float eventLat(const DisasterEvent& e)       { return e.lat100 / 100.0f; }
+inline float eventLon(const DisasterEvent& e)       { return e.lon100 / 100.0f; }
+
+// ----- Location arena -----
+// Queued events, the one on screen and the LoRa queues hold their location
+// text here by handle. The same text - an event in both the display and a
+// LoRa queue, repeated NWS headlines, GDACS country names - is stored once
+// and reference-counted. Released space is reclaimed by sliding the live
+// strings down when an intern doesn't fit; handles stay valid.
+// 8 bytes a slot plus ~30 a string, against 64 a copy per queue entry.
+
+#define LOCATION_SLOTS  96          // Distinct texts live at once (handles are a byte)
+#define LOCATION_ARENA  1536
+
+struct LocationSlot {
+    uint32_t hash;
+    uint16_t offset;
+    uint8_t  len;                   // Without the NUL
+    uint8_t  refs;                  // 0 = free
 };
 
-// Event type display names
-const char* getEventTypeName(const char* code) {
-    if (!code || strlen(code) == 0) return "ALERT";
-    
-    // Earthquakes & Geological
-    if (strcmp(code, "EQ") == 0) return "QUAKE";
-    if (strcmp(code, "VO") == 0) return "VOLCANO";
-    if (strcmp(code, "volcano") == 0) return "VOLCANO";
-    if (strcmp(code, "landslide") == 0) return "SLIDE";
-    
-    // Severe Weather (NWS)
-    if (strcmp(code, "TORNADO") == 0) return "TORNADO";
-    if (strcmp(code, "TSUNAMI") == 0) return "TSUNAMI";
-    if (strcmp(code, "TC") == 0) return "CYCLONE";
-    if (strcmp(code, "FL") == 0) return "FLOOD";
-    if (strcmp(code, "flood") == 0) return "FLOOD";
-    if (strcmp(code, "DR") == 0) return "DROUGHT";
-    if (strcmp(code, "STORM") == 0) return "STORM";
-    if (strcmp(code, "storm") == 0) return "STORM";
-    if (strcmp(code, "severeStorm") == 0) return "STORM";
-    if (strcmp(code, "SNOW") == 0) return "BLIZZARD";
-    if (strcmp(code, "snow") == 0) return "SNOW";
-    if (strcmp(code, "iceberg") == 0) return "ICEBERG";
-    if (strcmp(code, "WEATHER") == 0) return "WEATHER";
-    if (strcmp(code, "EXTREME") == 0) return "EXTREME";
-    
-    // Fire
-    if (strcmp(code, "WF") == 0) return "WILDFIRE";
-    if (strcmp(code, "fire") == 0) return "FIRE";
-    if (strcmp(code, "wildfire") == 0) return "FIRE";
-    
-    // Space Weather
-    if (strcmp(code, "SOLAR") == 0) return "SOLAR";
-    if (strcmp(code, "GEOMAG") == 0) return "GEOMAG";
-    if (strcmp(code, "RADIO") == 0) return "RADIO";
-    if (strcmp(code, "FLARE") == 0) return "FLARE";
-    if (strcmp(code, "CME") == 0) return "CME";
-    
-    // Military / Conflict (kept for future use)
-    if (strcmp(code, "WAR") == 0) return "WAR";
-    if (strcmp(code, "DEFCON") == 0) return "DEFCON";
-    if (strcmp(code, "NUKE") == 0) return "NUKE";
-    if (strcmp(code, "MILITARY") == 0) return "MILITARY";
-    if (strcmp(code, "CONFLICT") == 0) return "CONFLICT";
-    if (strcmp(code, "TERROR") == 0) return "TERROR";
-    if (strcmp(code, "EMERGENCY") == 0) return "EMERGENCY";
-    
-    // Health
-    if (strcmp(code, "EPIDEMIC") == 0) return "EPIDEMIC";
-    if (strcmp(code, "PANDEMIC") == 0) return "PANDEMIC";
-    if (strcmp(code, "OUTBREAK") == 0) return "OUTBREAK";
-    
-    // Other
-    if (strcmp(code, "CYBER") == 0) return "CYBER";
-    if (strcmp(code, "PLANE") == 0) return "PLANE";
-    if (strcmp(code, "SHIP") == 0) return "SHIP";
-    if (strcmp(code, "TRAIN") == 0) return "TRAIN";
-    
-    return "ALERT";
+LocationSlot locationSlots[LOCATION_SLOTS];   // Handle h is slot h - 1
+char         locationArena[LOCATION_ARENA];
+uint16_t     locationArenaUsed = 0;
+
+static void locationCompact() {
+    // Live slots by offset - sliding each down can't overwrite the next
+    uint8_t order[LOCATION_SLOTS];
+    int n = 0;
+    for (int i = 0; i < LOCATION_SLOTS; i++) {
+        if (!locationSlots[i].refs) continue;
+        int j = n++;
+        while (j > 0 && locationSlots[order[j - 1]].offset > locationSlots[i].offset) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    
+    uint16_t used = 0;
+    for (int k = 0; k < n; k++) {
+        LocationSlot& sl = locationSlots[order[k]];
+        memmove(locationArena + used, locationArena + sl.offset, sl.len + 1);
+        sl.offset = used;
+        used += sl.len + 1;
+    }
+    locationArenaUsed = used;
+}
+
+// Handle for text, sharing an existing copy - 0 if the arena is exhausted
+uint8_t locationIntern(const char* text) {
+    uint32_t h = fnv1a32(text);
+    size_t len = strnlen(text, 63);
+    
+    int freeSlot = -1;
+    for (int i = 0; i < LOCATION_SLOTS; i++) {
+        LocationSlot& sl = locationSlots[i];
+        if (!sl.refs) {
+            if (freeSlot < 0) freeSlot = i;
+            continue;
+        }
+        if (sl.hash == h && sl.len == len &&
+            memcmp(locationArena + sl.offset, text, len) == 0 && sl.refs < 255) {
+            sl.refs++;
+            return i + 1;
+        }
+    }
+    if (freeSlot < 0) {
+        Serial.println("[QUEUE] ⚠️ Location arena full");
+        return 0;
+    }
+    
+    if (locationArenaUsed + len + 1 > LOCATION_ARENA) locationCompact();
+    if (locationArenaUsed + len + 1 > LOCATION_ARENA) {
+        Serial.println("[QUEUE] ⚠️ Location arena full");
+        return 0;
+    }
+    
+    LocationSlot& sl = locationSlots[freeSlot];
+    sl.hash = h;
+    sl.offset = locationArenaUsed;
+    sl.len = len;
+    sl.refs = 1;
+    memcpy(locationArena + sl.offset, text, len);
+    locationArena[sl.offset + len] = '\0';
+    locationArenaUsed += len + 1;
+    return freeSlot + 1;
+}
+
+void locationRelease(uint8_t handle) {
+    if (handle == 0 || handle > LOCATION_SLOTS) return;
+    LocationSlot& sl = locationSlots[handle - 1];
+    if (sl.refs) sl.refs--;
+}
+
+// One more holder of a handle that is already live (a restored snapshot)
+static void locationRetain(uint8_t handle) {
+    if (handle == 0 || handle > LOCATION_SLOTS) return;
+    LocationSlot& sl = locationSlots[handle - 1];
+    if (sl.refs < 255) sl.refs++;
+}
+
+const char* locationText(uint8_t handle) {
+    if (handle == 0 || handle > LOCATION_SLOTS) return "";
+    return locationArena + locationSlots[handle - 1].offset;
+}
+
+const char* eventLocation(const DisasterEvent& e) {
+    return locationText(e.location);
+}
+
+static void packEvent(const FeedEvent* in, uint64_t idHash, DisasterEvent* out) {
+    out->idHash = idHash;
+    out->magnitude10 = (int16_t)lroundf(in->magnitude * 10);
+    out->lat100 = (int16_t)lroundf(in->lat * 100);
+    out->lon100 = (int16_t)lroundf(in->lon * 100);
+    out->location = locationIntern(in->location);
+    out->type = in->type;
+    out->alertLevel = in->alertLevel;
+    out->source = in->source;
 }
 
 // Alert level colors  
@@ -177,46 +353,96 @@ uint16_t getAlertColor(uint8_t level) {
     }
 }
 
-DisasterEvent displayQueue[5];
-int queueHead  = 0;
-int queueTail  = 0;
-int queueCount = 0;
+// Kept in display order: highest alert level first, newest first within a
+// level. When full, the last entry - oldest of the least severe - goes.
+#define DISPLAY_QUEUE_LEN 24
+
+DisasterEvent displayQueue[DISPLAY_QUEUE_LEN];
+int      queueCount = 0;
+uint32_t queueDropped[3];       // Per alert level - never displayed
+
+// ==================== LORA QUEUE (PER LEVEL) ====================
+#define LORA_QUEUE_SIZE 24  // Per alert level
+
+// Alert processing produces, the mesh scheduler consumes (LoraMessage is in
+// lora_frame.h). Each message holds a location arena reference: taken when
+// it's queued, given back when it's sent or dropped. Both ends run in loop(),
+// which the arena relies on.
+SpscRing<LoraMessage, LORA_QUEUE_SIZE> loraQueue[3];   // Indexed by alert level
+
+const char* loraLocation(const LoraMessage& m) {
+    return locationText(m.location);
+}
+
+// Take the oldest message off, giving back its location
+void loraDrop(uint8_t level) {
+    const LoraMessage* m = loraQueue[level].peek();
+    if (!m) return;
+    locationRelease(m->location);
+    loraQueue[level].drop();
+}
+
+void loraClear(uint8_t level) {
+    while (!loraQueue[level].empty()) loraDrop(level);
+}
+
+struct LoraStats {
+    uint32_t airtimeMs;     // Everything we transmitted, bot replies included
+    uint32_t packets;
+    uint32_t digests;       // Packets carrying more than one alert
+    uint32_t sent[3];       // Alerts delivered, per level
+    uint32_t waitSumS[3];   // Their total time in the queue
+    uint32_t waitMaxS[3];
+    uint32_t dropped[3];    // Queue full or went stale
+};
+
+LoraStats loraStats;
 
-// ==================== LORA QUEUE (HOURLY) ====================
-#define LORA_QUEUE_SIZE 20  // Larger queue for hourly batch
-char loraQueue[LORA_QUEUE_SIZE][80];
-int  loraQueueCount = 0;
+int loraPending() {
+    return loraQueue[0].size() + loraQueue[1].size() + loraQueue[2].size();
+}
 
 // ==================== FORWARD DECLARATIONS ====================
 void monitor_mesh_chat();
 void check_memory();
 void check_buttons();
 void emergency_clear_and_reboot();
-void eeprom_clear(void);
-void eeprom_save(void);
+void state_clear(void);
+void state_save(void);
+void seenClear(void);
+void resetQuakeDedup(void);
+void seenLogAppend(uint32_t slot);
+void seenLogReset(void);
+uint16_t feedSeenTtlHours(uint8_t source);
 void feed_watchdog(void);
 bool is_memory_safe(void);
-bool can_save_eeprom(void);
-void load_eeprom_write_count(void);
-void save_eeprom_write_count(void);
+bool can_save_state(void);
 void reset_uart_health(void);
+uint32_t getFeedHighWater(int idx);
+void setFeedHighWater(int idx, uint32_t t);
 void check_uart_health(void);
 void flush_uart_garbage(void);
-int fetchUSGS(void);
-int fetchEMSC(void);
-int fetchEONET(void);
-int fetchSpaceWeather(void);
-int fetchNWSAlerts(void);
-int fetchAllDisasters(void);
-void checkLoraHourlySend(void);
+void printFeedStats(void);
+void resetFeedCaches(void);
+int fetchAllDisasters(bool force);
+void requestFetch(bool full);
+void drainFetchedEvents(void);
+void startFetchTask(void);
+void loraService(void);
 void sendLoraQueueNow(void);
+void layoutQueued(void);
+TFT_eSPI& displayBegin();
+void displayPush();
+void displayFinish();
 
 // ==================== GLOBALS ====================
-unsigned long lastFetchTime     = 0;
+extern TaskHandle_t fetchTaskHandle;
 unsigned long lastDisplayChange = 0;
-bool          wifiConnected     = false;
+volatile bool wifiConnected     = false;
 DisasterEvent currentEvent;
 bool          showingAlert      = false;
+bool          idleShowsMap      = false;   // Idle screen is the world map, not the status
+unsigned long idleSwitchedAt    = 0;
 
 static unsigned long button1_hold_start = 0;
 static unsigned long button2_hold_start = 0;
@@ -227,7 +453,8 @@ static bool button2_held = false;
 
 void init_watchdog() {
     esp_task_wdt_init(WDT_TIMEOUT_SECONDS, true);  // Enable panic on timeout
-    esp_task_wdt_add(NULL);  // Add current thread to watchdog
+    esp_task_wdt_add(NULL);  // Add current thread (Arduino loop) to watchdog
+    
     Serial.println("[WDT] Watchdog initialized");
 }
 
@@ -265,163 +492,228 @@ void check_memory() {
             ESP.restart();
         } else if (free_heap < MIN_FREE_HEAP) {
             Serial.println("[MEM] ⚠️ LOW - Clearing queues");
+            for (int q = 0; q < queueCount; q++) {
+                locationRelease(displayQueue[q].location);
+            }
             queueCount = 0;
-            queueHead = 0;
-            queueTail = 0;
-            loraQueueCount = 0;
+            for (int l = 0; l < 3; l++) loraClear(l);
+            state_dirty = true;
         }
     }
 }
 
-// ==================== EEPROM PROTECTION ====================
+// ==================== STATE SNAPSHOTS ====================
 
-void load_eeprom_write_count() {
-    EEPROM.begin(EEPROM_SIZE);
-    
-    // Read lifetime write count from end of EEPROM
-    uint8_t b0 = EEPROM.read(EEPROM_WRITE_COUNT_ADDR);
-    uint8_t b1 = EEPROM.read(EEPROM_WRITE_COUNT_ADDR + 1);
-    uint8_t b2 = EEPROM.read(EEPROM_WRITE_COUNT_ADDR + 2);
-    uint8_t b3 = EEPROM.read(EEPROM_WRITE_COUNT_ADDR + 3);
-    
-    total_eeprom_writes = b0 | (b1 << 8) | (b2 << 16) | (b3 << 24);
-    
-    // Sanity check - if garbage, reset to 0
-    if (total_eeprom_writes > EEPROM_MAX_LIFETIME_WRITES * 2) {
-        total_eeprom_writes = 0;
-    }
-    
-    Serial.printf("[EEPROM] Lifetime writes: %u / %u\n", 
-                  total_eeprom_writes, EEPROM_MAX_LIFETIME_WRITES);
-    
-    if (total_eeprom_writes > EEPROM_MAX_LIFETIME_WRITES * 0.9) {
-        Serial.println("[EEPROM] ⚠️ WARNING: EEPROM nearing end of life!");
-        eeprom_write_allowed = false;
-    }
-    
-    hour_start_time = millis();
+struct StateSnapshot {
+    uint32_t      magic;
+    uint32_t      seq;              // Save counter - the highest valid one wins
+    uint16_t      version;
+    uint16_t      size;             // sizeof(StateSnapshot) - a layout change invalidates old ones
+    uint32_t      highWater[STATE_HWM_SLOTS];
+    uint8_t       queueCount;
+    uint8_t       loraQueueCount[3];
+    DisasterEvent displayQueue[DISPLAY_QUEUE_LEN];
+    LoraMessage   loraQueue[3][LORA_QUEUE_SIZE];
+    // The location arena as it was, so the queues' handles stay valid
+    LocationSlot  locationSlots[LOCATION_SLOTS];
+    char          locationArena[LOCATION_ARENA];
+    uint16_t      locationArenaUsed;
+    uint32_t      crc;              // CRC32 of everything above
+};
+
+static_assert(sizeof(StateSnapshot) <= STATE_SECTOR, "State snapshot must fit one flash sector");
+
+const esp_partition_t* statePart = NULL;
+int      stateSectors = 0;
+int      stateActive  = -1;         // Sector holding the newest snapshot
+uint32_t stateSeq     = 0;
+static StateSnapshot stateBuf;      // Too big for the loop() stack
+
+static uint32_t stateCrc(const StateSnapshot& st) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&st, offsetof(StateSnapshot, crc));
 }
 
-void save_eeprom_write_count() {
-    EEPROM.write(EEPROM_WRITE_COUNT_ADDR, total_eeprom_writes & 0xFF);
-    EEPROM.write(EEPROM_WRITE_COUNT_ADDR + 1, (total_eeprom_writes >> 8) & 0xFF);
-    EEPROM.write(EEPROM_WRITE_COUNT_ADDR + 2, (total_eeprom_writes >> 16) & 0xFF);
-    EEPROM.write(EEPROM_WRITE_COUNT_ADDR + 3, (total_eeprom_writes >> 24) & 0xFF);
+static bool stateValid(const StateSnapshot& st) {
+    return st.magic == STATE_MAGIC && st.version == STATE_VERSION &&
+           st.size == sizeof(StateSnapshot) && st.crc == stateCrc(st);
 }
 
-bool can_save_eeprom() {
-    // Check if EEPROM is near end of life
-    if (!eeprom_write_allowed) {
-        Serial.println("[EEPROM] ❌ Writes disabled - EEPROM worn out");
+bool can_save_state() {
+    // Check if the flash is near end of life
+    if (!state_write_allowed) {
+        Serial.println("[STATE] ❌ Writes disabled - flash worn out");
         return false;
     }
     
     // Check minimum time between saves
-    if (millis() - last_eeprom_save_time < EEPROM_MIN_SAVE_INTERVAL) {
-        Serial.println("[EEPROM] ⏳ Too soon since last save");
+    if (millis() - last_state_save_time < STATE_MIN_SAVE_INTERVAL) {
+        Serial.println("[STATE] ⏳ Too soon since last save");
         return false;
     }
     
     // Reset hourly counter
     if (millis() - hour_start_time > 3600000) {  // 1 hour
-        eeprom_saves_this_hour = 0;
+        state_saves_this_hour = 0;
         hour_start_time = millis();
     }
     
     // Check hourly limit
-    if (eeprom_saves_this_hour >= EEPROM_MAX_SAVES_PER_HOUR) {
-        Serial.println("[EEPROM] ❌ Hourly save limit reached");
+    if (state_saves_this_hour >= STATE_MAX_SAVES_PER_HOUR) {
+        Serial.println("[STATE] ❌ Hourly save limit reached");
         return false;
     }
     
     return true;
 }
 
-void eeprom_load() {
-    EEPROM.begin(EEPROM_SIZE);
-    
-    load_eeprom_write_count();
+void state_load() {
+    hour_start_time = millis();
     
-    if (EEPROM.read(0) != EEPROM_MAGIC || EEPROM.read(1) != EEPROM_VERSION) {
-        Serial.println("[EEPROM] Fresh start");
-        seenCount = 0;
-        seenIndex = 0;
+    statePart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                         (esp_partition_subtype_t)STATE_SUBTYPE, STATE_PARTITION);
+    if (!statePart || statePart->size < 2 * STATE_SECTOR) {
+        Serial.println("[STATE] ❌ No state partition - queues won't survive a reboot");
+        statePart = NULL;
         return;
     }
+    stateSectors = statePart->size / STATE_SECTOR;
+    
+    // Newest snapshot whose CRC checks out - a torn write just loses to the one before it
+    int rejected = 0;
+    for (int s = 0; s < stateSectors; s++) {
+        feed_watchdog();
+        if (esp_partition_read(statePart, s * STATE_SECTOR, &stateBuf, sizeof(stateBuf)) != ESP_OK) continue;
+        if (stateBuf.magic == 0xFFFFFFFF) continue;   // Erased
+        if (!stateValid(stateBuf)) {
+            rejected++;
+            continue;
+        }
+        if (stateActive < 0 || (int32_t)(stateBuf.seq - stateSeq) > 0) {
+            stateActive = s;
+            stateSeq = stateBuf.seq;
+        }
+    }
+    if (rejected) Serial.printf("[STATE] ⚠️ %d damaged snapshot(s) ignored\n", rejected);
+    
+    // Each sector has taken about seq / sectors erases
+    Serial.printf("[STATE] Lifetime saves: %u (~%u erases/sector)\n", stateSeq, stateSeq / stateSectors);
+    if (stateSeq / stateSectors > FLASH_MAX_SECTOR_ERASES * 0.9) {
+        Serial.println("[STATE] ⚠️ WARNING: state partition nearing end of life!");
+        state_write_allowed = false;
+    }
     
-    seenCount = EEPROM.read(2) | (EEPROM.read(3) << 8);
-    seenIndex = EEPROM.read(4) | (EEPROM.read(5) << 8);
+    if (stateActive < 0) {
+        Serial.println("[STATE] Fresh start");
+        return;
+    }
+    esp_partition_read(statePart, stateActive * STATE_SECTOR, &stateBuf, sizeof(stateBuf));
     
-    // Sanity checks
-    if (seenCount > MAX_EVENTS) seenCount = MAX_EVENTS;
-    if (seenIndex >= MAX_EVENTS) seenIndex = 0;
+    // Resume incremental queries where we left off
+    for (int i = 0; i < STATE_HWM_SLOTS; i++) {
+        uint32_t t = stateBuf.highWater[i];
+        if (t >= HWM_SANE_MIN && t <= HWM_SANE_MAX) setFeedHighWater(i, t);
+    }
     
-    int addr = 6;
-    for (int i = 0; i < seenCount; i++) {
-        for (int j = 0; j < ID_LENGTH; j++) {
-            seenEvents[i][j] = EEPROM.read(addr++);
+    // ... and the queues exactly as they were
+    if (stateBuf.queueCount <= DISPLAY_QUEUE_LEN &&
+        stateBuf.loraQueueCount[0] <= LORA_QUEUE_SIZE &&
+        stateBuf.loraQueueCount[1] <= LORA_QUEUE_SIZE &&
+        stateBuf.loraQueueCount[2] <= LORA_QUEUE_SIZE &&
+        stateBuf.locationArenaUsed <= LOCATION_ARENA) {
+        // The arena comes back whole; the references are counted again from
+        // the queues, so one held by the screen before the reboot isn't leaked
+        memcpy(locationSlots, stateBuf.locationSlots, sizeof(locationSlots));
+        memcpy(locationArena, stateBuf.locationArena, sizeof(locationArena));
+        locationArenaUsed = stateBuf.locationArenaUsed;
+        for (int i = 0; i < LOCATION_SLOTS; i++) locationSlots[i].refs = 0;
+        
+        memcpy(displayQueue, stateBuf.displayQueue, sizeof(displayQueue));
+        queueCount = stateBuf.queueCount;
+        for (int q = 0; q < queueCount; q++) locationRetain(displayQueue[q].location);
+        for (int l = 0; l < 3; l++) {
+            loraQueue[l].clear();
+            for (int i = 0; i < stateBuf.loraQueueCount[l]; i++) {
+                LoraMessage m = stateBuf.loraQueue[l][i];
+                m.queuedAt = millis();      // Age restarts - uptime before the reboot is gone
+                locationRetain(m.location);
+                loraQueue[l].push(m);
+            }
         }
+        layoutQueued();
     }
     
-    Serial.printf("[EEPROM] Loaded %d seen events\n", seenCount);
+    Serial.printf("[STATE] Restored snapshot %u from sector %d: %d queued, %d LoRa\n",
+                  stateSeq, stateActive, queueCount, loraPending());
 }
 
-void eeprom_save() {
+void state_save() {
+    if (!statePart) return;
+    
     // *** PROTECTION: Check if we can save ***
-    if (!can_save_eeprom()) {
+    if (!can_save_state()) {
+        last_state_save_time = millis();   // loop() retries after another interval
         return;
     }
     
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.write(0, EEPROM_MAGIC);
-    EEPROM.write(1, EEPROM_VERSION);
-    EEPROM.write(2, seenCount & 0xFF);
-    EEPROM.write(3, (seenCount >> 8) & 0xFF);
-    EEPROM.write(4, seenIndex & 0xFF);
-    EEPROM.write(5, (seenIndex >> 8) & 0xFF);
-    
-    int addr = 6;
-    for (int i = 0; i < seenCount; i++) {
-        for (int j = 0; j < ID_LENGTH; j++) {
-            EEPROM.write(addr++, seenEvents[i][j]);
+    memset(&stateBuf, 0, sizeof(stateBuf));
+    stateBuf.magic = STATE_MAGIC;
+    stateBuf.seq = stateSeq + 1;
+    stateBuf.version = STATE_VERSION;
+    stateBuf.size = sizeof(StateSnapshot);
+    for (int i = 0; i < STATE_HWM_SLOTS; i++) {
+        stateBuf.highWater[i] = getFeedHighWater(i);
+    }
+    stateBuf.queueCount = queueCount;
+    memcpy(stateBuf.displayQueue, displayQueue, sizeof(displayQueue));
+    memcpy(stateBuf.locationSlots, locationSlots, sizeof(locationSlots));
+    memcpy(stateBuf.locationArena, locationArena, sizeof(locationArena));
+    stateBuf.locationArenaUsed = locationArenaUsed;
+    for (int l = 0; l < 3; l++) {
+        stateBuf.loraQueueCount[l] = loraQueue[l].size();
+        for (int i = 0; i < stateBuf.loraQueueCount[l]; i++) {
+            stateBuf.loraQueue[l][i] = *loraQueue[l].peek(i);
         }
     }
+    stateBuf.crc = stateCrc(stateBuf);
     
-    // Update write counters
-    total_eeprom_writes++;
-    eeprom_saves_this_hour++;
-    save_eeprom_write_count();
+    // Never the sector holding the current snapshot
+    int next = (stateActive + 1) % stateSectors;
+    feed_watchdog();
+    if (esp_partition_erase_range(statePart, next * STATE_SECTOR, STATE_SECTOR) != ESP_OK ||
+        esp_partition_write(statePart, next * STATE_SECTOR, &stateBuf, sizeof(stateBuf)) != ESP_OK) {
+        Serial.println("[STATE] ❌ Snapshot write failed");
+        return;
+    }
     
-    EEPROM.commit();
+    stateActive = next;
+    stateSeq = stateBuf.seq;
+    state_dirty = false;
+    state_saves_this_hour++;
+    last_state_save_time = millis();
+    Serial.printf("[STATE] Saved snapshot %u to sector %d\n", stateSeq, stateActive);
+}
+
+// Forget saved state and seen IDs
+void state_clear() {
+    if (statePart) {
+        feed_watchdog();
+        esp_partition_erase_range(statePart, 0, stateSectors * STATE_SECTOR);
+        stateActive = -1;   // stateSeq keeps counting
+    }
+    seenLogReset();
+    last_state_save_time = millis();
     
-    last_eeprom_save_time = millis();
-    Serial.printf("[EEPROM] Saved %d events (writes: %u)\n", seenCount, total_eeprom_writes);
+    Serial.println("[STATE] Cleared");
 }
 
-void eeprom_clear() {
-    if (!can_save_eeprom()) {
-        Serial.println("[EEPROM] Cannot clear - save not allowed");
-        // Still clear RAM
-        seenCount = 0;
-        seenIndex = 0;
-        memset(seenEvents, 0, sizeof(seenEvents));
+void printStateStats() {
+    if (!statePart) {
+        Serial.println("[CMD] State: no partition");
         return;
     }
-    
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.write(0, 0x00);
-    
-    total_eeprom_writes++;
-    save_eeprom_write_count();
-    
-    EEPROM.commit();
-    
-    seenCount = 0;
-    seenIndex = 0;
-    memset(seenEvents, 0, sizeof(seenEvents));
-    last_eeprom_save_time = millis();
-    
-    Serial.println("[EEPROM] Cleared");
+    Serial.printf("[CMD] State: %u saves, newest in sector %d of %d, %u this hour%s\n",
+                  stateSeq, stateActive, stateSectors, state_saves_this_hour,
+                  state_dirty ? ", unsaved changes" : "");
 }
 
 // ==================== UART PROTECTION FUNCTIONS ====================
@@ -511,6 +803,29 @@ bool detect_reversed_uart() {
 
 // ==================== MESHTASTIC TX ====================
 
+long loraAirtimeMs(size_t bytes) {
+    return LORA_TX_OVERHEAD_MS + (long)bytes * LORA_MS_PER_BYTE;
+}
+
+void loraRefill() {
+    unsigned long now = millis();
+    unsigned long earned = (now - loraRefilledAt) / LORA_REFILL_MS;
+    if (earned == 0) return;
+    loraRefilledAt += earned * LORA_REFILL_MS;
+    loraTokensMs = min(LORA_BUCKET_MS, loraTokensMs + (long)earned);
+}
+
+// Replies to the mesh chat are charged too - they share the channel.
+// Debt is capped at one bucket so a red burst can't silence us for hours.
+void loraCharge(size_t bytes) {
+    long air = loraAirtimeMs(bytes);
+    loraRefill();
+    loraTokensMs = max(-LORA_BUCKET_MS, loraTokensMs - air);
+    loraLastTxAt = millis();
+    loraStats.airtimeMs += air;
+    loraStats.packets++;
+}
+
 void sendToHeltec(const char* message) {
     if (!message || strlen(message) == 0) return;
     if (!uart_healthy) {
@@ -521,61 +836,133 @@ void sendToHeltec(const char* message) {
     Serial.print("Bot> ");
     Serial.println(message);
     Serial1.println(message);
+    loraCharge(strlen(message));
     delay(100);
 }
 
-void queueLoraMessage(const char* message) {
-    if (loraQueueCount >= LORA_QUEUE_SIZE) {
-        Serial.println("[LORA] Queue full, dropping");
+void queueLoraMessage(const FeedEvent* evt) {
+    uint8_t level = min(evt->alertLevel, (uint8_t)2);
+    LoraMessage m;
+    m.type = evt->type;
+    m.magnitude10 = (int16_t)constrain(lroundf(evt->magnitude * 10), 0L, 999L);
+    m.location = locationIntern(evt->location);
+    m.queuedAt = millis();
+    if (!m.location || !loraQueue[level].push(m)) {
+        locationRelease(m.location);
+        loraStats.dropped[level]++;
+        Serial.printf("[LORA] Level %d queue or location store full, dropping\n", level);
         return;
     }
-    strncpy(loraQueue[loraQueueCount], message, 79);
-    loraQueue[loraQueueCount][79] = '\0';
-    loraQueueCount++;
+    state_dirty = true;
+}
+
+// The next packet for this level - see lora_frame.h
+int buildLoraPacket(uint8_t level, char* packet, size_t cap) {
+    return packLoraFrame(loraQueue[level], loraLocation, packet, cap);
+}
+
+// Send the next packet for this level. Returns how many alerts went out.
+int sendLoraDigest(uint8_t level) {
+    char packet[LORA_PAYLOAD_MAX + 1];
+    int count = buildLoraPacket(level, packet, sizeof(packet));
+    if (count == 0) return 0;
+    
+    for (int i = 0; i < count; i++) {
+        uint32_t waitS = (millis() - loraQueue[level].peek()->queuedAt) / 1000;
+        loraStats.waitSumS[level] += waitS;
+        if (waitS > loraStats.waitMaxS[level]) loraStats.waitMaxS[level] = waitS;
+        loraDrop(level);
+    }
+    
+    sendToHeltec(packet);
+    loraStats.sent[level] += count;
+    if (count > 1) loraStats.digests++;
+    state_dirty = true;
+    return count;
+}
+
+// Airtime the next packet of this level would take
+long loraNextCost(uint8_t level) {
+    char packet[LORA_PAYLOAD_MAX + 1];
+    if (buildLoraPacket(level, packet, sizeof(packet)) == 0) return 0;
+    return loraAirtimeMs(strlen(packet));
+}
+
+// Legend for the packed frames' type codes, split over as few packets as fit
+void sendLoraCodes() {
+    char packet[LORA_PAYLOAD_MAX + 1];
+    size_t len = snprintf(packet, sizeof(packet), "📖 ");
+    for (uint8_t t = 0; t < sizeof(EVENT_TYPE_INFO) / sizeof(EVENT_TYPE_INFO[0]); t++) {
+        char entry[24];
+        snprintf(entry, sizeof(entry), "%s=%s ", EVENT_TYPE_INFO[t].mesh, EVENT_TYPE_INFO[t].name);
+        if (len + strlen(entry) > LORA_PAYLOAD_MAX) {
+            sendToHeltec(packet);
+            delay(LORA_TX_GAP_MS);
+            len = 0;
+        }
+        len += snprintf(packet + len, sizeof(packet) - len, "%s", entry);
+    }
+    sendToHeltec(packet);
 }
 
-void flushLoraQueue() {
-    // Just mark that we have pending messages - actual send happens hourly
-    if (loraQueueCount > 0) {
-        loraHourlyPending = true;
-        Serial.printf("[LORA] %d messages queued for hourly send\n", loraQueueCount);
+// Called from loop() - at most one packet per call
+void loraService() {
+    // Green and orange that waited this long are old news
+    for (uint8_t l = 0; l < 2; l++) {
+        const LoraMessage* m;
+        while ((m = loraQueue[l].peek()) != NULL && millis() - m->queuedAt > LORA_MAX_AGE_MS) {
+            loraDrop(l);
+            loraStats.dropped[l]++;
+            state_dirty = true;
+        }
+    }
+    
+    if (loraPending() == 0 || !uart_healthy) return;
+    if (millis() - loraLastTxAt < LORA_TX_GAP_MS) return;
+    loraRefill();
+    
+    if (!loraQueue[2].empty()) {
+        sendLoraDigest(2);      // Never waits for budget
+    } else if (!loraQueue[1].empty() && loraTokensMs >= loraNextCost(1)) {
+        sendLoraDigest(1);
+    } else if (!loraQueue[0].empty() && loraTokensMs - loraNextCost(0) >= LORA_GREEN_RESERVE_MS) {
+        sendLoraDigest(0);
     }
 }
 
 void sendLoraQueueNow() {
-    // Force send all queued messages NOW (called by hourly timer or manual command)
-    if (loraQueueCount == 0) {
+    // Manual flush - ignores the budget, but the airtime is still charged
+    int count = loraPending();
+    if (count == 0) {
         Serial.println("[LORA] No messages to send");
         return;
     }
-    
-    Serial.printf("[LORA] 📡 Sending %d messages to mesh...\n", loraQueueCount);
-    delay(200);
-    
-    // Send summary header first
-    char header[80];
-    snprintf(header, sizeof(header), "=== ALERT DIGEST (%d events) ===", loraQueueCount);
-    sendToHeltec(header);
-    delay(500);
-    
-    // Send each message
-    for (int i = 0; i < loraQueueCount; i++) {
-        feed_watchdog();
-        sendToHeltec(loraQueue[i]);
-        delay(600);  // Slightly longer delay for reliability
+    if (!uart_healthy) {
+        Serial.println("[LORA] ❌ UART unhealthy, keeping queue");
+        return;
     }
     
-    loraQueueCount = 0;
-    loraHourlyPending = false;
-    lastLoraSendTime = millis();
-    
-    Serial.println("[LORA] ✅ Hourly digest sent");
+    Serial.printf("[LORA] 📡 Sending %d messages to mesh...\n", count);
+    for (int l = 2; l >= 0; l--) {
+        while (sendLoraDigest(l) > 0) {
+            feed_watchdog();
+            delay(LORA_TX_GAP_MS);
+        }
+    }
+    Serial.println("[LORA] ✅ Queue flushed");
 }
 
-void checkLoraHourlySend() {
-    // Check if it's time for hourly LoRa send
-    if (loraHourlyPending && (millis() - lastLoraSendTime >= LORA_SEND_INTERVAL_MS)) {
-        sendLoraQueueNow();
+void printLoraStats() {
+    static const char* LEVELS[3] = { "green", "orange", "red" };
+    loraRefill();
+    Serial.printf("[LORA] Airtime %lus in %u packets (%u digests), budget %ld/%ldms\n",
+                  (unsigned long)loraStats.airtimeMs / 1000, loraStats.packets, loraStats.digests,
+                  loraTokensMs, LORA_BUCKET_MS);
+    for (int l = 2; l >= 0; l--) {
+        Serial.printf("[LORA]   %-6s waiting:%d sent:%u avg wait:%us max:%us dropped:%u\n",
+                      LEVELS[l], (int)loraQueue[l].size(), loraStats.sent[l],
+                      loraStats.sent[l] ? loraStats.waitSumS[l] / loraStats.sent[l] : 0,
+                      loraStats.waitMaxS[l], loraStats.dropped[l]);
     }
 }
 
@@ -584,15 +971,18 @@ void checkLoraHourlySend() {
 void emergency_clear_and_reboot() {
     Serial.println("[EMERGENCY] Button hold - Clearing and rebooting!");
     
-    eeprom_clear();
+    state_clear();
     
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_RED, TFT_BLACK);
-    tft.drawString("EMERGENCY", 120, 40, 4);
-    tft.drawString("CLEAR", 120, 70, 4);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString("Rebooting...", 120, 100, 2);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_RED, TFT_BLACK);
+    gfx.drawString("EMERGENCY", 120, 40, 4);
+    gfx.drawString("CLEAR", 120, 70, 4);
+    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx.drawString("Rebooting...", 120, 100, 2);
+    displayPush();
+    displayFinish();
     
     delay(2000);
     ESP.restart();
@@ -630,9 +1020,9 @@ void check_buttons() {
         if (button2_hold_start > 0 && !button2_held) {
             if (millis() - button2_hold_start < BUTTON_HOLD_TIME) {
                 Serial.println("[BTN2] Short press - Refetch");
-                // Don't clear EEPROM on short press - just refetch
+                // Don't clear saved state on short press - just refetch
                 if (wifiConnected) {
-                    lastFetchTime = 0;  // Force fetch on next loop
+                    requestFetch(false);
                 }
             }
         }
@@ -641,744 +1031,2873 @@ void check_buttons() {
     }
 }
 
+// ==================== TEXT LAYOUT ====================
+// Alert text is laid out once, when its event is queued: the largest font
+// whose word-wrapped lines fit the location box wins, and the line breaks are
+// kept as spans into evt->location. showAlert() then only draws the spans.
+// Text too long even for the smallest font is cut with an ellipsis, or - with
+// a frame buffer - scrolled through as a one-line marquee instead.
+
+#define LAYOUT_X           10
+#define LAYOUT_Y           56
+#define LAYOUT_W           220
+#define LAYOUT_H           75
+#define LAYOUT_MAX_LINES   4
+#define MARQUEE_FONT       4
+#define MARQUEE_Y          77     // 26px font centred in tile rows 5-6, so frames push two tile rows
+#define MARQUEE_GAP        48     // Pixels between the end of the text and its next pass
+#define MARQUEE_STEP_PX    2
+#define MARQUEE_FRAME_MS   40
+
+struct LayoutSpan {
+    uint8_t start;
+    uint8_t len;
+};
+
+struct TextLayout {
+    uint8_t    font;
+    uint8_t    size;
+    uint8_t    lineHeight;
+    uint8_t    lineCount;
+    bool       ellipsis;        // Last span was cut short - "..." follows it
+    uint16_t   marqueeWidth;    // Whole text in MARQUEE_FONT when it doesn't fit, else 0
+    LayoutSpan line[LAYOUT_MAX_LINES];
+};
+
+struct LayoutFont {
+    uint8_t font;
+    uint8_t size;
+};
+
+// Largest first
+static const LayoutFont layoutFonts[] = { {2, 2}, {4, 1}, {2, 1} };
+#define LAYOUT_FONT_COUNT (sizeof(layoutFonts) / sizeof(layoutFonts[0]))
+
+TextLayout    layoutQueue[DISPLAY_QUEUE_LEN];   // Alongside displayQueue[]
+TextLayout    currentLayout;
+bool          marqueeActive = false;
+int           marqueeOffset = 0;
+unsigned long lastMarqueeFrame = 0;
+
+static int spanWidth(const char* text, int len, uint8_t font, uint8_t size) {
+    char buf[72];
+    if (len > (int)sizeof(buf) - 1) len = sizeof(buf) - 1;
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    return tft.textWidth(buf, font) * size;
+}
+
+// Greedy word wrap into at most LAYOUT_MAX_LINES lines - false if text is left over
+static bool wrapText(const char* text, const LayoutFont& f, int maxLines, TextLayout* out) {
+    int len = strlen(text);
+    int pos = 0;
+    out->lineCount = 0;
+    
+    while (true) {
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos >= len) return true;
+        if (out->lineCount >= maxLines) return false;
+        
+        int lineEnd = -1;
+        int scan = pos;
+        while (scan < len) {
+            int wordEnd = scan;
+            while (wordEnd < len && text[wordEnd] != ' ') wordEnd++;
+            if (spanWidth(text + pos, wordEnd - pos, f.font, f.size) > LAYOUT_W) break;
+            lineEnd = wordEnd;
+            scan = wordEnd;
+            while (scan < len && text[scan] == ' ') scan++;
+        }
+        
+        // A single word wider than the box - break it where it overflows
+        if (lineEnd < 0) {
+            lineEnd = pos + 1;
+            while (lineEnd < len && text[lineEnd] != ' ' &&
+                   spanWidth(text + pos, lineEnd + 1 - pos, f.font, f.size) <= LAYOUT_W) {
+                lineEnd++;
+            }
+        }
+        
+        out->line[out->lineCount].start = pos;
+        out->line[out->lineCount].len = lineEnd - pos;
+        out->lineCount++;
+        pos = lineEnd;
+    }
+}
+
+void layoutText(const char* text, TextLayout* out) {
+    memset(out, 0, sizeof(TextLayout));
+    tft.setTextSize(1);   // textWidth() scales by it - spanWidth() applies the size
+    
+    for (size_t i = 0; i < LAYOUT_FONT_COUNT; i++) {
+        const LayoutFont& f = layoutFonts[i];
+        int lineHeight = tft.fontHeight(f.font) * f.size;
+        int maxLines = min(LAYOUT_H / lineHeight, LAYOUT_MAX_LINES);
+        
+        out->font = f.font;
+        out->size = f.size;
+        out->lineHeight = lineHeight;
+        if (wrapText(text, f, maxLines, out)) return;
+    }
+    
+    // Doesn't fit at all: the smallest font's lines, last one ellipsized
+    LayoutSpan& last = out->line[out->lineCount - 1];
+    int dots = spanWidth("...", 3, out->font, out->size);
+    while (last.len > 0 &&
+           (text[last.start + last.len - 1] == ' ' ||
+            spanWidth(text + last.start, last.len, out->font, out->size) + dots > LAYOUT_W)) {
+        last.len--;
+    }
+    out->ellipsis = true;
+    out->marqueeWidth = spanWidth(text, strlen(text), MARQUEE_FONT, 1);
+}
+
+// Recompute layouts after the queue is restored from a snapshot
+void layoutQueued() {
+    for (int q = 0; q < queueCount; q++) {
+        layoutText(eventLocation(displayQueue[q]), &layoutQueue[q]);
+    }
+}
+
+// ==================== FRAME BUFFER ====================
+// Screens are composed in an 8-bit sprite; displayPush() then sends only the
+// tiles whose pixels changed since the last frame, so the panel never flashes
+// black and an unchanged screen costs no SPI traffic at all.
+// Without RAM for the sprite, screens draw straight to the TFT as before.
+//
+// With DMA the push only queues the dirty rectangles: each one is expanded to
+// RGB565 into one of two strip buffers and handed to the SPI DMA, and while
+// it transmits the CPU expands the next rectangle into the other buffer.
+// loop() calls displayService() to chain the strips, so a redraw never waits
+// on the bus. displayBusy is the completion flag.
+
+#define SCREEN_W            240
+#define SCREEN_H            135
+#define TILE_W              16
+#define TILE_H              15
+#define TILES_X             (SCREEN_W / TILE_W)
+#define TILES_Y             (SCREEN_H / TILE_H)
+#define SPI_WINDOW_OVERHEAD 11   // CASET + RASET + RAMWR bytes around each pushed rectangle
+#define DMA_STRIP_PIXELS    (SCREEN_W * TILE_H)          // Widest rectangle a push produces
+#define MAX_PUSH_RECTS      (TILES_Y * ((TILES_X + 1) / 2))  // Every other tile dirty
+static_assert(SCREEN_W % TILE_W == 0 && SCREEN_H % TILE_H == 0, "Tiles must cover the screen");
+
+struct DisplayStats {
+    uint32_t frames;
+    uint32_t unchanged;       // Frames that pushed nothing
+    uint32_t lastBytes;       // SPI bytes of the last frame
+    uint32_t lastRects;
+    uint32_t totalBytes;
+    uint32_t dmaStrips;
+    uint32_t waits;           // Redraws that had to wait for the previous push
+};
+
+struct PushRect {
+    int16_t x, y, w;          // Height is always TILE_H
+};
+
+TFT_eSprite   frame = TFT_eSprite(&tft);
+bool          frameReady = false;
+bool          frameForceFull = true;    // Panel content unknown - push every tile
+uint32_t      tileHash[TILES_Y][TILES_X];
+DisplayStats  displayStats;
+
+bool          dmaReady = false;
+bool          displayBusy = false;      // A push is still going out over DMA
+uint16_t*     dmaStrip[2] = { NULL, NULL };
+PushRect      pushRects[MAX_PUSH_RECTS];
+int           pushRectCount = 0;
+int           pushQueued = -1;          // Rect expanded and waiting in dmaStrip[pushQueuedBuf]
+int           pushQueuedBuf = 0;
+
+void initFrameBuffer() {
+    frame.setColorDepth(8);
+    frameReady = frame.createSprite(SCREEN_W, SCREEN_H) != nullptr;
+    if (frameReady) {
+        Serial.printf("[TFT] Frame buffer %dx%d 8-bit (%u bytes)\n", SCREEN_W, SCREEN_H,
+                      SCREEN_W * SCREEN_H);
+    } else {
+        Serial.println("[TFT] ⚠️ No RAM for frame buffer - drawing direct");
+        return;
+    }
+    
+    for (int i = 0; i < 2; i++) {
+        dmaStrip[i] = (uint16_t*)heap_caps_malloc(DMA_STRIP_PIXELS * 2, MALLOC_CAP_DMA);
+    }
+    if (dmaStrip[0] && dmaStrip[1] && tft.initDMA()) {
+        dmaReady = true;
+        Serial.printf("[TFT] DMA pushes, 2 x %u byte strips\n", DMA_STRIP_PIXELS * 2);
+    } else {
+        free(dmaStrip[0]);
+        free(dmaStrip[1]);
+        dmaStrip[0] = dmaStrip[1] = NULL;
+        Serial.println("[TFT] ⚠️ No DMA - pushes will block");
+    }
+}
+
+// Expand one rectangle of the 8-bit frame to byte-swapped RGB565 for the DMA
+static void expandStrip(const PushRect& r, uint16_t* out) {
+    const uint8_t* buf = (const uint8_t*)frame.getPointer();
+    for (int row = 0; row < TILE_H; row++) {
+        const uint8_t* p = buf + (r.y + row) * SCREEN_W + r.x;
+        for (int c = 0; c < r.w; c++) {
+            uint16_t px = tft.color8to16(p[c]);
+            *out++ = (px >> 8) | (px << 8);
+        }
+    }
+}
+
+// Chain the next strip once the DMA is idle - call often, never blocks
+void displayService() {
+    if (!displayBusy || tft.dmaBusy()) return;
+    
+    if (pushQueued >= 0) {
+        const PushRect& r = pushRects[pushQueued];
+        tft.pushImageDMA(r.x, r.y, r.w, TILE_H, dmaStrip[pushQueuedBuf]);
+        displayStats.dmaStrips++;
+        
+        // The other buffer finished transmitting - refill it while this one goes out
+        int next = pushQueued + 1;
+        pushQueuedBuf ^= 1;
+        if (next < pushRectCount) {
+            expandStrip(pushRects[next], dmaStrip[pushQueuedBuf]);
+            pushQueued = next;
+        } else {
+            pushQueued = -1;
+        }
+        return;
+    }
+    
+    tft.endWrite();
+    displayBusy = false;
+}
+
+// Drain an in-flight push - for callers about to block or redraw
+void displayFinish() {
+    while (displayBusy) {
+        tft.dmaWait();
+        displayService();
+    }
+}
+
+// Where screen functions draw
+TFT_eSPI& displayBegin() {
+    marqueeActive = false;   // A new screen replaces the scrolling alert
+    
+    // The strips still to be expanded read from the frame - let them go first
+    if (displayBusy) {
+        displayStats.waits++;
+        displayFinish();
+    }
+    return frameReady ? (TFT_eSPI&)frame : (TFT_eSPI&)tft;
+}
+
+static uint32_t hashTile(const uint8_t* buf, int tx, int ty) {
+    uint32_t h = 2166136261UL;
+    for (int r = 0; r < TILE_H; r++) {
+        const uint8_t* p = buf + (ty * TILE_H + r) * SCREEN_W + tx * TILE_W;
+        for (int c = 0; c < TILE_W; c++) {
+            h ^= p[c];
+            h *= 16777619UL;
+        }
+    }
+    return h;
+}
+
+// Send the changed tiles - runs of dirty tiles in a row go out as one rectangle
+void displayPush() {
+    if (!frameReady) return;
+    
+    const uint8_t* buf = (const uint8_t*)frame.getPointer();
+    uint32_t bytes = 0, rects = 0;
+    
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        int runStart = -1;
+        for (int tx = 0; tx <= TILES_X; tx++) {
+            bool dirty = false;
+            if (tx < TILES_X) {
+                uint32_t h = hashTile(buf, tx, ty);
+                dirty = frameForceFull || h != tileHash[ty][tx];
+                tileHash[ty][tx] = h;
+            }
+            if (dirty && runStart < 0) runStart = tx;
+            if (!dirty && runStart >= 0) {
+                int x = runStart * TILE_W;
+                int y = ty * TILE_H;
+                int w = (tx - runStart) * TILE_W;
+                if (dmaReady) {
+                    pushRects[rects] = { (int16_t)x, (int16_t)y, (int16_t)w };
+                } else {
+                    frame.pushSprite(x, y, x, y, w, TILE_H);
+                }
+                bytes += w * TILE_H * 2 + SPI_WINDOW_OVERHEAD;
+                rects++;
+                runStart = -1;
+            }
+        }
+    }
+    
+    if (dmaReady && rects > 0) {
+        pushRectCount = rects;
+        expandStrip(pushRects[0], dmaStrip[0]);
+        pushQueued = 0;
+        pushQueuedBuf = 0;
+        displayBusy = true;
+        tft.startWrite();     // CS stays low until the last strip is out
+        displayService();
+    }
+    
+    frameForceFull = false;
+    displayStats.frames++;
+    if (rects == 0) displayStats.unchanged++;
+    displayStats.lastBytes = bytes;
+    displayStats.lastRects = rects;
+    displayStats.totalBytes += bytes;
+}
+
+void printDisplayStats() {
+    const DisplayStats& d = displayStats;
+    uint32_t full = SCREEN_W * SCREEN_H * 2;
+    Serial.printf("[CMD] Display: %s%s, %u frames (%u unchanged)\n",
+                  frameReady ? "frame buffer" : "direct", dmaReady ? " + DMA" : "",
+                  d.frames, d.unchanged);
+    if (dmaReady) {
+        Serial.printf("[CMD] DMA: %u strips, %u redraws waited, %s\n",
+                      d.dmaStrips, d.waits, displayBusy ? "busy" : "idle");
+    }
+    Serial.printf("[CMD] Last frame: %u SPI bytes in %u rects (full redraw: %u)\n",
+                  d.lastBytes, d.lastRects, full);
+    if (d.frames) {
+        Serial.printf("[CMD] Average: %u bytes/frame (%u%% of full redraws)\n",
+                      d.totalBytes / d.frames,
+                      (uint32_t)((uint64_t)d.totalBytes * 100 / ((uint64_t)full * d.frames)));
+    }
+}
+
 // ==================== DISPLAY FUNCTIONS ====================
 
 void showStartup() {
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    tft.drawString("DISASTER", 120, 50, 4);
-    tft.drawString("ALERT", 120, 85, 4);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx.drawString("DISASTER", 120, 50, 4);
+    gfx.drawString("ALERT", 120, 85, 4);
+    
+    displayPush();
 }
 
 void showFetching() {
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_ORANGE, TFT_BLACK);
-    tft.drawString("FETCHING", 120, 50, 4);
-    tft.drawString("DATA...", 120, 85, 4);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_ORANGE, TFT_BLACK);
+    gfx.drawString("FETCHING", 120, 50, 4);
+    gfx.drawString("DATA...", 120, 85, 4);
+    
+    displayPush();
 }
 
 void showNoAlerts() {
-    tft.fillScreen(TFT_BLACK);
-    tft.drawRect(0, 0, 240, 135, TFT_GREEN);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.drawString("MONITORING", 120, 50, 4);
-    tft.setTextColor(TFT_DARKCYAN, TFT_BLACK);
-    tft.drawString("NO ALERTS", 120, 85, 4);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.drawRect(0, 0, 240, 135, TFT_GREEN);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_GREEN, TFT_BLACK);
+    gfx.drawString("MONITORING", 120, 50, 4);
+    gfx.setTextColor(TFT_DARKCYAN, TFT_BLACK);
+    gfx.drawString("NO ALERTS", 120, 85, 4);
     
     // Show memory status
     char mem[32];
     snprintf(mem, sizeof(mem), "Mem:%uK", ESP.getFreeHeap() / 1024);
-    tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    tft.drawString(mem, 120, 120, 1);
+    gfx.setTextColor(TFT_DARKGREY, TFT_BLACK);
+    gfx.drawString(mem, 120, 120, 1);
+    
+    displayPush();
 }
 
 void showConnecting(int dots) {
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.drawString("CONNECTING", 120, 50, 4);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx.drawString("CONNECTING", 120, 50, 4);
     
     String d = "WIFI ";
     for (int i = 0; i < (dots % 5); i++) d += ".";
-    tft.drawString(d, 120, 85, 4);
+    gfx.drawString(d, 120, 85, 4);
+    
+    displayPush();
 }
 
 void showConnected() {
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.drawString("CONNECTED", 120, 50, 4);
-    tft.drawString(WiFi.localIP().toString(), 120, 85, 4);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_GREEN, TFT_BLACK);
+    gfx.drawString("CONNECTED", 120, 50, 4);
+    gfx.drawString(WiFi.localIP().toString(), 120, 85, 4);
+    
+    displayPush();
 }
 
 void showError(const char* msg) {
-    tft.fillScreen(TFT_BLACK);
-    tft.drawRect(0, 0, 240, 135, TFT_RED);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(TFT_RED, TFT_BLACK);
-    tft.drawString("ERROR", 120, 45, 4);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString(msg, 120, 85, 2);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
+    gfx.drawRect(0, 0, 240, 135, TFT_RED);
+    gfx.setTextDatum(MC_DATUM);
+    gfx.setTextColor(TFT_RED, TFT_BLACK);
+    gfx.drawString("ERROR", 120, 45, 4);
+    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx.drawString(msg, 120, 85, 2);
+    
+    displayPush();
 }
 
-void showAlert(DisasterEvent* evt) {
-    tft.fillScreen(TFT_BLACK);
+// Draw one marquee frame into the band - never waits on an in-flight push
+static void drawMarquee(const char* text, const TextLayout* layout) {
+    int period = layout->marqueeWidth + MARQUEE_GAP;
+    int x = LAYOUT_X - marqueeOffset;
+    
+    frame.setTextSize(1);
+    frame.fillRect(0, MARQUEE_Y, SCREEN_W, frame.fontHeight(MARQUEE_FONT), TFT_BLACK);
+    frame.setTextDatum(TL_DATUM);
+    frame.setTextColor(TFT_WHITE, TFT_BLACK);
+    frame.drawString(text, x, MARQUEE_Y, MARQUEE_FONT);
+    if (x + period < SCREEN_W) frame.drawString(text, x + period, MARQUEE_Y, MARQUEE_FONT);
+    
+    displayPush();
+}
+
+// Advance the alert marquee - called from loop()
+void marqueeService() {
+    if (!marqueeActive || displayBusy) return;
+    if (millis() - lastMarqueeFrame < MARQUEE_FRAME_MS) return;
+    lastMarqueeFrame = millis();
+    
+    marqueeOffset = (marqueeOffset + MARQUEE_STEP_PX) % (currentLayout.marqueeWidth + MARQUEE_GAP);
+    drawMarquee(eventLocation(currentEvent), &currentLayout);
+}
+
+void showAlert(const DisasterEvent* evt, const TextLayout* layout) {
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
     
     // Use alert color based on level
     uint16_t c = getAlertColor(evt->alertLevel);
     
     // Top color bar
-    tft.fillRect(0, 0, 240, 10, c);
+    gfx.fillRect(0, 0, 240, 10, c);
     
     // Event type (QUAKE, CYCLONE, FIRE, etc.)
     const char* typeName = getEventTypeName(evt->type);
-    tft.setTextDatum(TL_DATUM);
-    tft.setTextColor(c, TFT_BLACK);
-    tft.drawString(typeName, 10, 20, 4);
+    gfx.setTextDatum(TL_DATUM);
+    gfx.setTextColor(getEventTypeColor(evt->type), TFT_BLACK);
+    gfx.drawString(typeName, 10, 20, 4);
     
     // Magnitude (only if > 0)
-    if (evt->magnitude > 0) {
+    if (evt->magnitude10 > 0) {
         char mag[16];
-        sprintf(mag, "M%.1f", evt->magnitude);
-        tft.setTextDatum(TR_DATUM);
-        tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-        tft.drawString(mag, 230, 20, 4);
+        sprintf(mag, "M%.1f", eventMagnitude(*evt));
+        gfx.setTextDatum(TR_DATUM);
+        gfx.setTextColor(TFT_YELLOW, TFT_BLACK);
+        gfx.drawString(mag, 230, 20, 4);
+    }
+    
+    // Location - too long to fit, scroll it
+    if (layout->marqueeWidth && frameReady) {
+        marqueeOffset = 0;
+        lastMarqueeFrame = millis();
+        drawMarquee(eventLocation(*evt), layout);
+        marqueeActive = true;
+        return;
     }
     
-    // Location
-    tft.setTextDatum(TL_DATUM);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.setCursor(10, 60);
-    tft.setTextFont(2);
-    tft.setTextSize(2);
-    tft.setTextWrap(true, true);
-    tft.print(evt->location);
+    // Otherwise the precomputed lines
+    const char* location = eventLocation(*evt);
+    gfx.setTextDatum(TL_DATUM);
+    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx.setTextSize(layout->size);
+    for (int i = 0; i < layout->lineCount; i++) {
+        char line[72];
+        const LayoutSpan& sp = layout->line[i];
+        memcpy(line, location + sp.start, sp.len);
+        line[sp.len] = '\0';
+        if (layout->ellipsis && i == layout->lineCount - 1) strcat(line, "...");
+        gfx.drawString(line, LAYOUT_X, LAYOUT_Y + i * layout->lineHeight, layout->font);
+    }
+    gfx.setTextSize(1);
+    
+    displayPush();
 }
 
 void display_mesh_chat(const char* message) {
-    tft.fillScreen(TFT_BLACK);
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillScreen(TFT_BLACK);
     
     // Blue border for chat messages
-    tft.drawRect(0, 0, 240, 135, TFT_BLUE);
-    tft.drawRect(1, 1, 238, 133, TFT_BLUE);
+    gfx.drawRect(0, 0, 240, 135, TFT_BLUE);
+    gfx.drawRect(1, 1, 238, 133, TFT_BLUE);
     
     // Header
-    tft.setTextDatum(TC_DATUM);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawString("MESH CHAT", 120, 10, 4);
+    gfx.setTextDatum(TC_DATUM);
+    gfx.setTextColor(TFT_WHITE, TFT_BLACK);
+    gfx.drawString("MESH CHAT", 120, 10, 4);
     
     // Divider line
-    tft.drawLine(10, 35, 230, 35, TFT_BLUE);
+    gfx.drawLine(10, 35, 230, 35, TFT_BLUE);
     
     // Message text
-    tft.setTextDatum(TL_DATUM);
-    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-    tft.setCursor(10, 45);
-    tft.setTextFont(2);
-    tft.setTextSize(2);
-    tft.setTextWrap(true, true);
-    tft.print(message);
+    gfx.setTextDatum(TL_DATUM);
+    gfx.setTextColor(TFT_YELLOW, TFT_BLACK);
+    gfx.setCursor(10, 45);
+    gfx.setTextFont(2);
+    gfx.setTextSize(2);
+    gfx.setTextWrap(true, true);
+    gfx.print(message);
+    
+    displayPush();
+}
+
+// ==================== EVENT TRACKING ====================
+
+void seenClear() {
+    seen.clear();
+    resetQuakeDedup();   // Or a cleared quake would merge into its old twin
+}
+
+// Current 4-hour unit (mod 256), -1 until SNTP has set the clock
+static int seenNowUnit() {
+    time_t now = time(NULL);
+    if (now < (time_t)HWM_SANE_MIN) return -1;
+    return (now / SEEN_TTL_UNIT_S) & 0xFF;
+}
+
+// Sweep out everything expired; if that isn't enough, evict the entry that
+// would have expired soonest (undated ones first)
+static void seenMakeRoom() {
+    int now = seenNowUnit();
+    int expired = seen.sweep(now);
+    if (expired) Serial.printf("[SEEN] Expired %d IDs\n", expired);
+    if (seen.count < SEEN_MAX_LOAD) return;
+    
+    seen.evictSoonest(now);
+    Serial.println("[SEEN] ⚠️ Table full - evicted one early");
+}
+
+// Expiry stamp for an ID seen now, kept for ttlH hours
+static uint8_t seenExpiryStamp(uint16_t ttlH) {
+    int now = seenNowUnit();
+    if (now < 0) return 0;
+    uint32_t units = (min((uint32_t)ttlH, (uint32_t)SEEN_TTL_MAX_H) * 3600UL + SEEN_TTL_UNIT_S - 1) / SEEN_TTL_UNIT_S;
+    uint8_t expiry = (now + units + 1) & 0xFF;   // +1: the current unit is already part gone
+    return expiry ? expiry : 1;
+}
+
+bool isEventSeen(uint64_t idHash) {
+    return seen.contains(idHash, seenNowUnit());
+}
+
+// Insert or overwrite a slot value - used for new IDs and log replay
+void seenPut(uint32_t slot) {
+    int now = seenNowUnit();
+    if (!seen.slots[seen.probe(slot & SEEN_FP_MASK, now)] && seen.count >= SEEN_MAX_LOAD) {
+        seenMakeRoom();
+    }
+    seen.set(slot, now);
+}
+
+// Remember id for its feed's window - or, if already known, restart the clock
+void markEventSeen(uint64_t idHash, uint8_t source) {
+    uint32_t fp = seen.fingerprint(idHash);
+    uint32_t stamp = (uint32_t)seenExpiryStamp(feedSeenTtlHours(source)) << 24;
+    int i = seen.probe(fp, seenNowUnit());
+    if (seen.slots[i]) {
+        // Only worth a log record when the 4-hour stamp actually moves
+        if (stamp && (seen.slots[i] & ~SEEN_FP_MASK) != stamp) {
+            seen.slots[i] = stamp | fp;
+            seenLogAppend(seen.slots[i]);
+        }
+        return;
+    }
+    
+    seenPut(stamp | fp);
+    seenLogAppend(stamp | fp);
+    
+    Serial.printf("[SEEN] %06x (total:%d)\n", fp, seen.count);
+}
+
+// ----- Cross-source duplicates -----
+// USGS and EMSC both report the big quakes. Recent located events are keyed
+// into 1 degree x 2 minute grid cells; a new one that lands in the same or a
+// neighbouring cell, from another agency, and really is within 1 degree and
+// 2 minutes is the same quake.
+
+#define DEDUP_CELL_DEG   1.0f
+#define DEDUP_BUCKET_S   120
+#define DEDUP_RECENT     16
+
+struct QuakeCell {
+    uint64_t idHash;
+    uint8_t  source;            // Same feed = distinct events (aftershocks), not a duplicate
+    int16_t  cellLat;
+    int16_t  cellLon;
+    uint32_t bucket;
+    uint32_t originTime;
+    float    lat;
+    float    lon;
+};
+
+QuakeCell recentQuakes[DEDUP_RECENT];
+int       recentQuakeIndex = 0;
+uint32_t  quakesMerged = 0;
+
+static void quakeCellOf(const FeedEvent* evt, QuakeCell* c) {
+    c->cellLat = (int16_t)floorf(evt->lat / DEDUP_CELL_DEG);
+    c->cellLon = (int16_t)floorf(evt->lon / DEDUP_CELL_DEG);
+    c->bucket  = evt->originTime / DEDUP_BUCKET_S;
+}
+
+// Earlier record of the same quake from another agency, or NULL
+QuakeCell* findQuakeDuplicate(const FeedEvent* evt) {
+    if (evt->originTime == 0) return NULL;
+    
+    QuakeCell key;
+    quakeCellOf(evt, &key);
+    const int lonCells = (int)(360.0f / DEDUP_CELL_DEG);
+    
+    for (int i = 0; i < DEDUP_RECENT; i++) {
+        QuakeCell& c = recentQuakes[i];
+        if (c.originTime == 0 || c.source == evt->source) continue;
+        
+        // Neighbour cells, with the longitude wrapping at the date line
+        int dLon = abs(c.cellLon - key.cellLon);
+        if (dLon > lonCells / 2) dLon = lonCells - dLon;
+        if (abs(c.cellLat - key.cellLat) > 1 || dLon > 1 ||
+            abs((int32_t)(c.bucket - key.bucket)) > 1) continue;
+        
+        float dLonDeg = fabsf(c.lon - evt->lon);
+        if (dLonDeg > 180.0f) dLonDeg = 360.0f - dLonDeg;
+        if (fabsf(c.lat - evt->lat) <= DEDUP_CELL_DEG && dLonDeg <= DEDUP_CELL_DEG &&
+            abs((int32_t)(c.originTime - evt->originTime)) <= DEDUP_BUCKET_S) {
+            return &c;
+        }
+    }
+    return NULL;
+}
+
+void resetQuakeDedup() {
+    memset(recentQuakes, 0, sizeof(recentQuakes));
+    recentQuakeIndex = 0;
+}
+
+void rememberQuake(const FeedEvent* evt, uint64_t idHash) {
+    if (evt->originTime == 0) return;
+    QuakeCell& c = recentQuakes[recentQuakeIndex];
+    c.idHash = idHash;
+    c.source = evt->source;
+    quakeCellOf(evt, &c);
+    c.originTime = evt->originTime;
+    c.lat = evt->lat;
+    c.lon = evt->lon;
+    recentQuakeIndex = (recentQuakeIndex + 1) % DEDUP_RECENT;
+}
+
+// ----- Display queue -----
+
+// An event leaving the queue undisplayed is still handled - don't let the
+// next poll bring it back
+static void queueDrop(uint8_t level, uint64_t idHash, uint8_t source) {
+    queueDropped[min(level, (uint8_t)2)]++;
+    markEventSeen(idHash, source);
+}
+
+static void queueRemoveAt(int i) {
+    memmove(&displayQueue[i], &displayQueue[i + 1], (queueCount - i - 1) * sizeof(DisasterEvent));
+    memmove(&layoutQueue[i], &layoutQueue[i + 1], (queueCount - i - 1) * sizeof(TextLayout));
+    queueCount--;
+}
+
+// Move an entry whose level went up ahead of the less severe ones
+static void queueRaise(int i) {
+    while (i > 0 && displayQueue[i - 1].alertLevel < displayQueue[i].alertLevel) {
+        DisasterEvent e = displayQueue[i - 1];
+        displayQueue[i - 1] = displayQueue[i];
+        displayQueue[i] = e;
+        TextLayout l = layoutQueue[i - 1];
+        layoutQueue[i - 1] = layoutQueue[i];
+        layoutQueue[i] = l;
+        i--;
+    }
+}
+
+// A red event waiting while something less urgent is on screen
+bool queuePreempts(bool showingAlert, const DisasterEvent& current) {
+    return queueCount > 0 && displayQueue[0].alertLevel >= 2 &&
+           (!showingAlert || current.alertLevel < 2);
+}
+
+// Fold a duplicate into the record we already have: keep the higher alert
+// level on the queued copy, and don't see the duplicate again
+void mergeQuakeDuplicate(const QuakeCell* orig, const FeedEvent* dup) {
+    int16_t mag10 = (int16_t)lroundf(dup->magnitude * 10);
+    for (int q = 0; q < queueCount; q++) {
+        DisasterEvent& e = displayQueue[q];
+        if (e.idHash != orig->idHash) continue;
+        if (dup->alertLevel > e.alertLevel) {
+            e.alertLevel = dup->alertLevel;
+            queueRaise(q);
+        }
+        if (mag10 > e.magnitude10) e.magnitude10 = mag10;
+        state_dirty = true;
+        break;
+    }
+    markEventSeen(eventIdHash(dup->id), dup->source);
+    quakesMerged++;
+    Serial.printf("[DEDUP] %s repeats an earlier report - merged\n", dup->id);
+}
+
+// Already waiting in the display queue (e.g. restored from a snapshot)
+bool isQueued(uint64_t idHash) {
+    for (int q = 0; q < queueCount; q++) {
+        if (displayQueue[q].idHash == idHash) return true;
+    }
+    return false;
+}
+
+bool addToQueue(const FeedEvent* evt) {
+    uint64_t idHash = eventIdHash(evt->id);
+    
+    // Still in its feed - keep remembering it for another window
+    if (isEventSeen(idHash)) {
+        markEventSeen(idHash, evt->source);
+        return false;
+    }
+    if (isQueued(idHash)) return false;
+    
+    QuakeCell* dup = findQuakeDuplicate(evt);
+    if (dup) {
+        mergeQuakeDuplicate(dup, evt);
+        return false;
+    }
+    rememberQuake(evt, idHash);
+    
+    const char* typeName = getEventTypeName(evt->type);
+    bool queued = true;
+    
+    // Full: the least important event goes - which may be this one
+    if (queueCount >= DISPLAY_QUEUE_LEN) {
+        const DisasterEvent& last = displayQueue[queueCount - 1];
+        if (evt->alertLevel < last.alertLevel) {
+            queueDrop(evt->alertLevel, idHash, evt->source);
+            queued = false;
+            Serial.printf("[QUEUE] %s %s dropped - queue full of worse\n", typeName, evt->location);
+        } else {
+            queueDrop(last.alertLevel, last.idHash, last.source);
+            locationRelease(last.location);
+            queueRemoveAt(queueCount - 1);
+        }
+    }
+    
+    if (queued) {
+        int pos = 0;
+        while (pos < queueCount && displayQueue[pos].alertLevel > evt->alertLevel) pos++;
+        memmove(&displayQueue[pos + 1], &displayQueue[pos], (queueCount - pos) * sizeof(DisasterEvent));
+        memmove(&layoutQueue[pos + 1], &layoutQueue[pos], (queueCount - pos) * sizeof(TextLayout));
+        packEvent(evt, idHash, &displayQueue[pos]);
+        layoutText(evt->location, &layoutQueue[pos]);
+        queueCount++;
+        state_dirty = true;
+        Serial.printf("[QUEUE] %s %s (q:%d, #%d)\n", typeName, evt->location, queueCount, pos + 1);
+    }
+    
+    queueLoraMessage(evt);
+    
+    return true;
+}
+
+// The queue's reference to the location moves to evt, which drops its old one
+bool getFromQueue(DisasterEvent* evt, TextLayout* layout) {
+    if (queueCount == 0) return false;
+    
+    locationRelease(evt->location);
+    *evt = displayQueue[0];
+    *layout = layoutQueue[0];
+    queueRemoveAt(0);
+    state_dirty = true;
+    markEventSeen(evt->idHash, evt->source);
+    
+    return true;
+}
+
+// ==================== SEEN LOG (FLASH) ====================
+// The seen set is persisted as an append-only log in its own "seenlog"
+// partition (see partitions_16MB.csv). A new or refreshed ID costs one 8-byte
+// record. When the active sector fills up, the live table is compacted into
+// the next sector, so erases rotate through the whole partition.
+//
+// Sector: [records...] ... [header at offset 0, written last]
+// The header carries a sequence number - the highest valid one is the live
+// sector. Nothing else needs replaying since every sector starts with a full
+// snapshot.
+
+#define SEEN_LOG_PARTITION   "seenlog"
+#define SEEN_LOG_SUBTYPE     0x40
+#define SEEN_LOG_SECTOR      4096
+#define SEEN_LOG_MAX_SECTORS 32
+#define SEEN_LOG_MAGIC       0x5EE10C01UL
+#define SEEN_REC_SET         0x5E01
+
+struct SeenLogHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t erases;    // Erase count of this sector, including the one just done
+    uint32_t crc;       // CRC32 of the fields above
+};
+
+struct SeenLogRecord {
+    uint32_t slot;      // seen.slots[] value: expiry stamp | fingerprint
+    uint16_t kind;
+    uint16_t crc;       // CRC16 of slot + kind
+};
+
+static_assert(sizeof(SeenLogHeader) == 16 && sizeof(SeenLogRecord) == 8, "Seen log layout");
+static_assert(sizeof(SeenLogHeader) + SEEN_MAX_LOAD * sizeof(SeenLogRecord) <= SEEN_LOG_SECTOR,
+              "A compacted seen table must fit one log sector");
+
+const esp_partition_t* seenLogPart = NULL;
+int      seenLogSectors = 0;
+int      seenLogActive  = -1;
+uint32_t seenLogOffset  = 0;            // Next free byte in the active sector
+uint32_t seenLogSeq     = 0;
+uint32_t seenLogBytesWritten = 0;       // Since boot
+uint32_t seenLogErases[SEEN_LOG_MAX_SECTORS];
+
+static uint32_t seenHeaderCrc(const SeenLogHeader& h) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&h, offsetof(SeenLogHeader, crc));
+}
+
+static uint16_t seenRecordCrc(const SeenLogRecord& r) {
+    return esp_rom_crc16_le(0, (const uint8_t*)&r, offsetof(SeenLogRecord, crc));
+}
+
+static bool seenLogWrite(uint32_t offset, const void* data, size_t len) {
+    esp_err_t err = esp_partition_write(seenLogPart, offset, data, len);
+    if (err != ESP_OK) {
+        Serial.printf("[SEENLOG] ❌ Write failed: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    seenLogBytesWritten += len;
+    return true;
+}
+
+// Start the next sector with a snapshot of the live table
+static void seenLogCompact() {
+    if (!seenLogPart) return;
+    int next = (seenLogActive + 1) % seenLogSectors;
+    uint32_t base = next * SEEN_LOG_SECTOR;
+    
+    feed_watchdog();
+    if (esp_partition_erase_range(seenLogPart, base, SEEN_LOG_SECTOR) != ESP_OK) {
+        Serial.println("[SEENLOG] ❌ Erase failed");
+        return;
+    }
+    seenLogErases[next]++;
+    
+    static SeenLogRecord recs[SEEN_MAX_LOAD];   // 2.4KB - too big for the loop() stack
+    int n = 0;
+    int now = seenNowUnit();
+    for (int i = 0; i < SEEN_SLOTS && n < SEEN_MAX_LOAD; i++) {
+        if (!seen.slots[i] || seen.expired(seen.slots[i], now)) continue;
+        recs[n].slot = seen.slots[i];
+        recs[n].kind = SEEN_REC_SET;
+        recs[n].crc  = seenRecordCrc(recs[n]);
+        n++;
+    }
+    if (n > 0 && !seenLogWrite(base + sizeof(SeenLogHeader), recs, n * sizeof(SeenLogRecord))) return;
+    
+    // Header last - a reset before this point leaves the old sector live
+    SeenLogHeader h = { SEEN_LOG_MAGIC, seenLogSeq + 1, seenLogErases[next], 0 };
+    h.crc = seenHeaderCrc(h);
+    if (!seenLogWrite(base, &h, sizeof(h))) return;
+    
+    seenLogActive = next;
+    seenLogSeq    = h.seq;
+    seenLogOffset = sizeof(SeenLogHeader) + n * sizeof(SeenLogRecord);
+    Serial.printf("[SEENLOG] Compacted %d IDs into sector %d (erases:%u)\n",
+                  n, next, seenLogErases[next]);
+}
+
+void seenLogAppend(uint32_t slot) {
+    if (!seenLogPart) return;
+    if (seenLogOffset + sizeof(SeenLogRecord) > SEEN_LOG_SECTOR) {
+        seenLogCompact();   // The snapshot already holds this slot
+        return;
+    }
+    
+    SeenLogRecord r = { slot, SEEN_REC_SET, 0 };
+    r.crc = seenRecordCrc(r);
+    if (seenLogWrite(seenLogActive * SEEN_LOG_SECTOR + seenLogOffset, &r, sizeof(r))) {
+        seenLogOffset += sizeof(r);
+    }
+}
+
+// Forget everything, in RAM and on flash
+void seenLogReset() {
+    seenClear();
+    seenLogCompact();
+}
+
+// Rebuild the in-RAM seen set from the live sector
+void seenLogLoad() {
+    seenClear();
+    seenLogPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           (esp_partition_subtype_t)SEEN_LOG_SUBTYPE,
+                                           SEEN_LOG_PARTITION);
+    if (!seenLogPart) {
+        Serial.println("[SEENLOG] ❌ No seenlog partition - seen IDs won't survive a reboot");
+        return;
+    }
+    seenLogSectors = min((int)(seenLogPart->size / SEEN_LOG_SECTOR), SEEN_LOG_MAX_SECTORS);
+    if (seenLogSectors < 2) {
+        Serial.println("[SEENLOG] ❌ Partition too small - need at least 2 sectors");
+        seenLogPart = NULL;
+        return;
+    }
+    
+    for (int s = 0; s < seenLogSectors; s++) {
+        SeenLogHeader h;
+        if (esp_partition_read(seenLogPart, s * SEEN_LOG_SECTOR, &h, sizeof(h)) != ESP_OK) continue;
+        if (h.magic != SEEN_LOG_MAGIC || h.crc != seenHeaderCrc(h)) continue;
+        seenLogErases[s] = h.erases;
+        if (seenLogActive < 0 || (int32_t)(h.seq - seenLogSeq) > 0) {
+            seenLogActive = s;
+            seenLogSeq = h.seq;
+        }
+    }
+    
+    if (seenLogActive < 0) {
+        Serial.println("[SEENLOG] Fresh log");
+        seenLogActive = seenLogSectors - 1;   // Compaction moves on to sector 0
+        seenLogCompact();
+        return;
+    }
+    
+    uint32_t base = seenLogActive * SEEN_LOG_SECTOR;
+    uint32_t offset = sizeof(SeenLogHeader);
+    int records = 0;
+    bool torn = false;
+    while (offset + sizeof(SeenLogRecord) <= SEEN_LOG_SECTOR) {
+        SeenLogRecord r;
+        if (esp_partition_read(seenLogPart, base + offset, &r, sizeof(r)) != ESP_OK) {
+            torn = true;
+            break;
+        }
+        if (r.slot == 0xFFFFFFFF && r.kind == 0xFFFF && r.crc == 0xFFFF) break;  // Erased = end of log
+        if (r.kind != SEEN_REC_SET || r.crc != seenRecordCrc(r)) {
+            torn = true;   // Interrupted append
+            break;
+        }
+        seenPut(r.slot);
+        records++;
+        offset += sizeof(r);
+    }
+    seenLogOffset = offset;
+    
+    Serial.printf("[SEENLOG] Replayed %d records from sector %d -> %d seen IDs\n",
+                  records, seenLogActive, seen.count);
+    
+    // Don't append after a bad record - start clean
+    if (torn) seenLogCompact();
+}
+
+void printSeenLogStats() {
+    if (!seenLogPart) {
+        Serial.println("[CMD] Seen log: no partition");
+        return;
+    }
+    Serial.printf("[CMD] Seen log: %u bytes written since boot, sector %d at %u/%u, seq %u\n",
+                  seenLogBytesWritten, seenLogActive, seenLogOffset, SEEN_LOG_SECTOR, seenLogSeq);
+    Serial.print("[CMD] Erases per sector:");
+    for (int s = 0; s < seenLogSectors; s++) {
+        Serial.printf(" %u", seenLogErases[s]);
+    }
+    Serial.println();
+}
+
+// ==================== EVENT HISTORY (FLASH) ====================
+// Every new event is archived in the "history" partition as a fixed 128-byte
+// record - ~20k events in 2.5MB, oldest sectors recycled first.
+//
+// Slot 0 of each sector is its header. The first half (magic + sequence) is
+// written when the sector is started; the summary half (time span, type bits,
+// top magnitude) once it's full. The summaries are the index - a query only
+// reads the records of sectors whose summary can match.
+
+#define HISTORY_PARTITION   "history"
+#define HISTORY_SUBTYPE     0x41
+#define HISTORY_SECTOR      4096
+#define HISTORY_RECORD      128
+#define HISTORY_PER_SECTOR  (HISTORY_SECTOR / HISTORY_RECORD - 1)
+#define HISTORY_MAGIC       0x4157C001UL
+
+struct HistoryRecord {
+    uint32_t seenAt;            // When we archived it (epoch s), 0 = clock not set
+    uint32_t originTime;        // 0 = feed has none
+    float    magnitude;
+    float    lat;
+    float    lon;
+    uint8_t  alertLevel;
+    uint8_t  source;
+    uint8_t  reserved[2];
+    char     id[ID_LENGTH];
+    char     type[12];
+    char     location[64];
+    uint32_t crc;               // CRC32 of everything above
+};
+
+struct HistorySectorHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t openCrc;           // CRC32 of magic + seq
+    // Summary - all 0xFF until the sector is sealed
+    uint32_t tMin;
+    uint32_t tMax;
+    uint32_t typeBits;          // Bit historyTypeBit(type) for every type inside
+    float    maxMag;
+    uint32_t count;
+    uint32_t sealCrc;           // CRC32 of tMin..count
+};
+
+static_assert(sizeof(HistoryRecord) == HISTORY_RECORD, "History record must stay 128 bytes");
+static_assert(sizeof(HistorySectorHeader) <= HISTORY_RECORD, "History header must fit slot 0");
+
+struct HistoryQuery {
+    bool        byType;         // false = any type
+    EventType   type;
+    uint32_t    from;           // Event time range (epoch s), 0 = open
+    uint32_t    to;
+    float       minMag;         // 0 = any
+};
+
+const esp_partition_t* historyPart = NULL;
+int      historySectors = 0;
+int      historyHead    = -1;       // Sector being filled
+int      historyHeadCount = 0;      // Records in it
+uint32_t historySeq     = 0;
+uint32_t historyAppends = 0;        // Bumped per archived event - lets readers cache
+HistorySectorHeader historyHeadSummary;
+
+// Event time: when it happened if the feed says, else when we saw it
+static uint32_t historyTime(const HistoryRecord& r) {
+    return r.originTime ? r.originTime : r.seenAt;
+}
+
+static uint32_t historyTypeBit(const char* type) {
+    uint32_t h = 2166136261UL;
+    while (*type) {
+        h ^= (uint8_t)tolower(*type++);
+        h *= 16777619UL;
+    }
+    return 1UL << (h % 32);
+}
+
+static uint32_t historyRecordCrc(const HistoryRecord& r) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&r, offsetof(HistoryRecord, crc));
+}
+
+static uint32_t historySealCrc(const HistorySectorHeader& h) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&h.tMin,
+                            offsetof(HistorySectorHeader, sealCrc) - offsetof(HistorySectorHeader, tMin));
+}
+
+static void historySummaryReset(HistorySectorHeader& h) {
+    h.tMin = UINT32_MAX;
+    h.tMax = 0;
+    h.typeBits = 0;
+    h.maxMag = 0;
+    h.count = 0;
+}
+
+static void historySummaryAdd(HistorySectorHeader& h, const HistoryRecord& r) {
+    uint32_t t = historyTime(r);
+    if (t < h.tMin) h.tMin = t;
+    if (t > h.tMax) h.tMax = t;
+    // Also when we archived it, so tMax never falls from one sector to the
+    // next and a query can stop at the first sector older than its range
+    if (r.seenAt > h.tMax) h.tMax = r.seenAt;
+    h.typeBits |= historyTypeBit(r.type);
+    if (r.magnitude > h.maxMag) h.maxMag = r.magnitude;
+    h.count++;
+}
+
+static uint32_t historySlotAddr(int sector, int slot) {
+    return sector * HISTORY_SECTOR + (slot + 1) * HISTORY_RECORD;
+}
+
+static bool historyReadRecord(int sector, int slot, HistoryRecord& r) {
+    return esp_partition_read(historyPart, historySlotAddr(sector, slot), &r, sizeof(r)) == ESP_OK &&
+           r.crc == historyRecordCrc(r);
+}
+
+// Write the summary half of the head's header
+static void historySeal() {
+    HistorySectorHeader& h = historyHeadSummary;
+    h.sealCrc = historySealCrc(h);
+    esp_partition_write(historyPart, historyHead * HISTORY_SECTOR + offsetof(HistorySectorHeader, tMin),
+                        &h.tMin, sizeof(h) - offsetof(HistorySectorHeader, tMin));
+}
+
+// Recycle the next (oldest) sector as the new head
+static bool historyOpenNext() {
+    int next = (historyHead + 1) % historySectors;
+    feed_watchdog();
+    if (esp_partition_erase_range(historyPart, next * HISTORY_SECTOR, HISTORY_SECTOR) != ESP_OK) {
+        Serial.println("[HISTORY] ❌ Erase failed");
+        return false;
+    }
+    
+    HistorySectorHeader h;
+    h.magic = HISTORY_MAGIC;
+    h.seq = historySeq + 1;
+    h.openCrc = esp_rom_crc32_le(0, (const uint8_t*)&h, offsetof(HistorySectorHeader, openCrc));
+    if (esp_partition_write(historyPart, next * HISTORY_SECTOR, &h,
+                            offsetof(HistorySectorHeader, tMin)) != ESP_OK) {
+        Serial.println("[HISTORY] ❌ Header write failed");
+        return false;
+    }
+    
+    historyHead = next;
+    historySeq = h.seq;
+    historyHeadCount = 0;
+    historySummaryReset(historyHeadSummary);
+    return true;
+}
+
+// Header of a sector, if it belongs to the live run ending at the head
+static bool historyReadHeader(int sector, uint32_t expectSeq, HistorySectorHeader& h) {
+    if (esp_partition_read(historyPart, sector * HISTORY_SECTOR, &h, sizeof(h)) != ESP_OK) return false;
+    return h.magic == HISTORY_MAGIC && h.seq == expectSeq &&
+           h.openCrc == esp_rom_crc32_le(0, (const uint8_t*)&h, offsetof(HistorySectorHeader, openCrc));
+}
+
+void historyLoad() {
+    historyPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                           (esp_partition_subtype_t)HISTORY_SUBTYPE,
+                                           HISTORY_PARTITION);
+    if (!historyPart || historyPart->size < 2 * HISTORY_SECTOR) {
+        Serial.println("[HISTORY] ❌ No history partition - events won't be archived");
+        historyPart = NULL;
+        return;
+    }
+    historySectors = historyPart->size / HISTORY_SECTOR;
+    
+    // Head = the sector with the newest sequence number
+    for (int s = 0; s < historySectors; s++) {
+        HistorySectorHeader h;
+        if (esp_partition_read(historyPart, s * HISTORY_SECTOR, &h, sizeof(h)) != ESP_OK) continue;
+        if (h.magic != HISTORY_MAGIC ||
+            h.openCrc != esp_rom_crc32_le(0, (const uint8_t*)&h, offsetof(HistorySectorHeader, openCrc))) continue;
+        if (historyHead < 0 || (int32_t)(h.seq - historySeq) > 0) {
+            historyHead = s;
+            historySeq = h.seq;
+        }
+    }
+    
+    if (historyHead < 0) {
+        Serial.println("[HISTORY] Fresh archive");
+        historyHead = historySectors - 1;
+        historyOpenNext();
+        return;
+    }
+    
+    // Rebuild the head's summary and find where appends continue
+    historySummaryReset(historyHeadSummary);
+    historyHeadSummary.magic = HISTORY_MAGIC;
+    historyHeadSummary.seq = historySeq;
+    historyHeadCount = 0;
+    bool torn = false;
+    for (int slot = 0; slot < HISTORY_PER_SECTOR; slot++) {
+        HistoryRecord r;
+        if (!historyReadRecord(historyHead, slot, r)) {
+            torn = r.seenAt != 0xFFFFFFFF;   // Not erased = interrupted write
+            break;
+        }
+        historySummaryAdd(historyHeadSummary, r);
+        historyHeadCount++;
+    }
+    
+    Serial.printf("[HISTORY] Head sector %d (seq %u) holds %d events\n",
+                  historyHead, historySeq, historyHeadCount);
+    
+    // Never write after a damaged slot
+    if (torn || historyHeadCount == HISTORY_PER_SECTOR) {
+        historySeal();
+        historyOpenNext();
+    }
+}
+
+void historyAppend(const FeedEvent* evt) {
+    if (!historyPart) return;
+    
+    HistoryRecord r;
+    memset(&r, 0, sizeof(r));
+    time_t now = time(NULL);
+    r.seenAt = now >= (time_t)HWM_SANE_MIN ? (uint32_t)now : 0;
+    r.originTime = evt->originTime;
+    r.magnitude = evt->magnitude;
+    r.lat = evt->lat;
+    r.lon = evt->lon;
+    r.alertLevel = evt->alertLevel;
+    r.source = evt->source;
+    strncpy(r.id, evt->id, sizeof(r.id) - 1);
+    strncpy(r.type, getEventTypeCode(evt->type), sizeof(r.type) - 1);
+    strncpy(r.location, evt->location, sizeof(r.location) - 1);
+    r.crc = historyRecordCrc(r);
+    
+    if (esp_partition_write(historyPart, historySlotAddr(historyHead, historyHeadCount),
+                            &r, sizeof(r)) != ESP_OK) {
+        Serial.println("[HISTORY] ❌ Write failed");
+        return;
+    }
+    historySummaryAdd(historyHeadSummary, r);
+    historyAppends++;
+    
+    if (++historyHeadCount == HISTORY_PER_SECTOR) {
+        historySeal();
+        historyOpenNext();
+    }
+}
+
+static bool historyMatches(const HistoryQuery& q, const HistoryRecord& r) {
+    uint32_t t = historyTime(r);
+    if (q.byType && parseEventType(r.type) != q.type) return false;
+    if (q.from && t < q.from) return false;
+    if (q.to && t > q.to) return false;
+    return r.magnitude >= q.minMag;
+}
+
+// Newest first. Returns the number of records written to out[].
+int historyQuery(const HistoryQuery& q, HistoryRecord* out, int maxOut) {
+    if (!historyPart) return 0;
+    
+    uint32_t typeBit = q.byType ? historyTypeBit(getEventTypeCode(q.type)) : 0;
+    int found = 0;
+    int sectorsRead = 0;
+    
+    for (int k = 0; k < historySectors && found < maxOut; k++) {
+        int sector = (historyHead - k + historySectors) % historySectors;
+        int count;
+        HistorySectorHeader h;
+        
+        if (k == 0) {
+            h = historyHeadSummary;
+            count = historyHeadCount;
+        } else {
+            if (!historyReadHeader(sector, historySeq - k, h)) break;   // Older than the archive
+            count = HISTORY_PER_SECTOR;
+            
+            // Sealed sectors can be skipped on their summary alone
+            if (h.sealCrc == historySealCrc(h)) {
+                if (q.from && h.tMax < q.from) break;    // Every older sector is older still
+                if (q.to && h.tMin > q.to) continue;
+                if (typeBit && !(h.typeBits & typeBit)) continue;
+                if (h.maxMag < q.minMag) continue;
+                count = h.count;
+            }
+        }
+        
+        sectorsRead++;
+        for (int slot = count - 1; slot >= 0 && found < maxOut; slot--) {
+            if (historyReadRecord(sector, slot, out[found]) && historyMatches(q, out[found])) {
+                found++;
+            }
+        }
+        feed_watchdog();
+    }
+    
+    Serial.printf("[HISTORY] Query: %d found, %d sectors read\n", found, sectorsRead);
+    return found;
+}
+
+// ==================== WORLD MAP ====================
+// The idle screen alternates (slowly) with a world map of what is going on:
+// everything archived in the last 24h, as dots coloured by alert level and
+// sized by magnitude. The land mask (include/world_map.h) is
+// run-length coded in flash and decoded row by row into one line buffer,
+// the markers crossing that row are drawn into it, and the row goes out.
+// One pass, one 480-byte line - the map needs no frame of its own.
+// The markers are cached: flash is only searched again once something new
+// was archived or the 24h window has moved on, and the map is only redrawn
+// when the markers actually changed.
+
+#define MAP_Y             15        // Below a one-tile-row title bar
+#define MAP_MAX_MARKERS   24
+#define MAP_RECENT_S      (24UL * 3600UL)
+#define MAP_REFRESH_MS    (10UL * 60UL * 1000UL)   // Let old events age off the map
+#define MAP_SEA           0x0009    // Dark blue
+#define MAP_LAND          0x3A27    // Dark olive
+
+struct MapMarker {
+    int16_t  x, y;                  // Map pixel, y relative to MAP_Y
+    uint8_t  r;
+    uint8_t  alertLevel;
+    uint16_t color;
+};
+
+// Pixel of every whole degree - the map is 1.5 degrees per pixel, so that's exact enough
+static uint8_t mapLonX[361];
+static uint8_t mapLatY[181];
+static bool    mapTablesReady = false;
+
+static void mapBuildTables() {
+    for (int i = 0; i <= 360; i++) {
+        mapLonX[i] = min(i * WORLD_MAP_W / 360, WORLD_MAP_W - 1);
+    }
+    for (int i = 0; i <= 180; i++) {
+        mapLatY[i] = min(i * WORLD_MAP_H / 180, WORLD_MAP_H - 1);
+    }
+    mapTablesReady = true;
+}
+
+static bool mapAddMarker(MapMarker* out, int& n, float lat, float lon, float mag, uint8_t level) {
+    if (n >= MAP_MAX_MARKERS) return false;
+    if (lat == 0 && lon == 0) return true;          // Feed gave no coordinates
+    if (lat < -90 || lat > 90 || lon < -180 || lon > 180) return true;
+    
+    MapMarker& m = out[n++];
+    m.x = mapLonX[(int)lroundf(lon) + 180];
+    m.y = mapLatY[90 - (int)lroundf(lat)];
+    m.r = mag > 0 ? constrain((int)mag - 2, 2, 6) : 2;   // M4 = 2px ... M8+ = 6px
+    m.alertLevel = level;
+    m.color = getAlertColor(level);
+    return true;
+}
+
+// Last 24h of the archive - reddest drawn last. The map only shows while
+// nothing is queued, so the archive is all there is to draw.
+static int collectMapMarkers(MapMarker* out) {
+    int n = 0;
+    time_t now = time(NULL);
+    if (now >= (time_t)HWM_SANE_MIN) {
+        HistoryQuery q = { false, EventType::Alert, (uint32_t)now - MAP_RECENT_S, 0, 0 };
+        static HistoryRecord recent[MAP_MAX_MARKERS];   // 3KB - off the loop stack
+        int found = historyQuery(q, recent, MAP_MAX_MARKERS);
+        for (int i = 0; i < found; i++) {
+            if (!mapAddMarker(out, n, recent[i].lat, recent[i].lon,
+                              recent[i].magnitude, recent[i].alertLevel)) break;
+        }
+    }
+    
+    for (int i = 1; i < n; i++) {
+        MapMarker m = out[i];
+        int j = i - 1;
+        while (j >= 0 && (out[j].alertLevel > m.alertLevel ||
+                          (out[j].alertLevel == m.alertLevel && out[j].r > m.r))) {
+            out[j + 1] = out[j];
+            j--;
+        }
+        out[j + 1] = m;
+    }
+    return n;
+}
+
+static void mapFillSpan(uint16_t* line, int cx, int dy, int r, uint16_t color) {
+    if (dy * dy > r * r) return;
+    int half = (int)sqrtf((float)(r * r - dy * dy));
+    int x0 = max(cx - half, 0);
+    int x1 = min(cx + half, WORLD_MAP_W - 1);
+    for (int x = x0; x <= x1; x++) line[x] = color;
+}
+
+static MapMarker     mapMarkers[MAP_MAX_MARKERS];
+static int           mapMarkerCount = -1;     // -1 = not collected yet
+static uint32_t      mapMarkersAppends;       // historyAppends when collected
+static unsigned long mapMarkersAt;
+
+// Collect again if the archive grew or the window moved on. True when the
+// markers differ from the cached ones.
+static bool mapRefreshMarkers() {
+    if (mapMarkerCount >= 0 && mapMarkersAppends == historyAppends &&
+        millis() - mapMarkersAt < MAP_REFRESH_MS) return false;
+    
+    MapMarker fresh[MAP_MAX_MARKERS];
+    int n = collectMapMarkers(fresh);
+    mapMarkersAppends = historyAppends;
+    mapMarkersAt = millis();
+    
+    bool changed = n != mapMarkerCount || memcmp(fresh, mapMarkers, n * sizeof(MapMarker)) != 0;
+    memcpy(mapMarkers, fresh, n * sizeof(MapMarker));
+    mapMarkerCount = n;
+    return changed;
+}
+
+// Draws the map when it isn't up yet (force) or its markers changed
+void showWorldMap(bool force) {
+    if (!mapTablesReady) mapBuildTables();
+    
+    bool changed = mapRefreshMarkers();
+    if (!force && !changed) return;
+    const MapMarker* markers = mapMarkers;
+    int n = mapMarkerCount;
+    
+    TFT_eSPI& gfx = displayBegin();
+    gfx.fillRect(0, 0, SCREEN_W, MAP_Y, TFT_BLACK);
+    gfx.setTextColor(TFT_CYAN, TFT_BLACK);
+    gfx.setTextDatum(ML_DATUM);
+    gfx.drawString("WORLD", 4, MAP_Y / 2, 2);
+    char count[24];
+    snprintf(count, sizeof(count), "%d events", n);
+    gfx.setTextDatum(MR_DATUM);
+    gfx.drawString(count, SCREEN_W - 4, MAP_Y / 2, 2);
+    
+    uint16_t line[WORLD_MAP_W];
+    const uint8_t* run = worldMapRuns;
+    
+    for (int row = 0; row < WORLD_MAP_H; row++) {
+        // Land mask
+        int x = 0;
+        bool land = false;
+        while (x < WORLD_MAP_W) {
+            int len = min((int)*run++, WORLD_MAP_W - x);
+            uint16_t c = land ? MAP_LAND : MAP_SEA;
+            for (int i = 0; i < len; i++) line[x++] = c;
+            land = !land;
+        }
+        
+        // Markers crossing this row, with a black rim so they read on land
+        for (int i = 0; i < n; i++) {
+            int dy = row - markers[i].y;
+            mapFillSpan(line, markers[i].x, dy, markers[i].r + 1, TFT_BLACK);
+            mapFillSpan(line, markers[i].x, dy, markers[i].r, markers[i].color);
+        }
+        
+        if (frameReady) {
+            frame.pushImage(0, MAP_Y + row, WORLD_MAP_W, 1, line);
+        } else {
+            tft.setSwapBytes(true);
+            tft.pushImage(0, MAP_Y + row, WORLD_MAP_W, 1, line);
+            tft.setSwapBytes(false);
+        }
+    }
+    
+    displayPush();
+}
+
+// ==================== TLS SESSION CACHE ====================
+
+#define TLS_SESSION_SLOTS   8       // One per feed host
+#define TLS_HOST_LEN        48
+
+struct TlsSessionSlot {
+    char                host[TLS_HOST_LEN];
+    mbedtls_ssl_session session;
+    bool                valid;
+    uint32_t            handshakes;     // Full handshakes
+    uint32_t            resumed;        // Abbreviated handshakes from the cached session
+    uint32_t            lastHandshakeMs;
+};
+
+TlsSessionSlot tlsSessions[TLS_SESSION_SLOTS];
+static int tlsNextSlot = 0;
+
+static mbedtls_entropy_context  tlsEntropy;
+static mbedtls_ctr_drbg_context tlsDrbg;
+static bool tlsRngReady = false;
+
+void tlsRngInit() {
+    if (tlsRngReady) return;
+    mbedtls_entropy_init(&tlsEntropy);
+    mbedtls_ctr_drbg_init(&tlsDrbg);
+    mbedtls_ctr_drbg_seed(&tlsDrbg, mbedtls_entropy_func, &tlsEntropy,
+                          (const unsigned char*)"E844", 4);
+    tlsRngReady = true;
+}
+
+// Did the server take the session we offered? With a session ID it echoes the
+// ID back; anything else is a new session. With a ticket the client sends a
+// fresh random ID each time, so that proves nothing - a resumed session keeps
+// its master secret, a full handshake derives a new one.
+static bool tlsSameSession(const mbedtls_ssl_session& offered, const mbedtls_ssl_session& got) {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    if (offered.ticket_len > 0) {
+        return memcmp(offered.master, got.master, sizeof(got.master)) == 0;
+    }
+#endif
+    return offered.id_len > 0 && got.id_len == offered.id_len &&
+           memcmp(offered.id, got.id, got.id_len) == 0;
+}
+
+TlsSessionSlot* tlsSlotFor(const char* host) {
+    for (auto& s : tlsSessions) {
+        if (strcmp(s.host, host) == 0) return &s;
+    }
+    
+    // Not cached yet - take the next slot round-robin
+    TlsSessionSlot* slot = &tlsSessions[tlsNextSlot];
+    tlsNextSlot = (tlsNextSlot + 1) % TLS_SESSION_SLOTS;
+    if (slot->valid) mbedtls_ssl_session_free(&slot->session);
+    memset(slot, 0, sizeof(*slot));
+    strncpy(slot->host, host, TLS_HOST_LEN - 1);
+    return slot;
+}
+
+// WiFiClientSecure does a full handshake on every connect. This client offers
+// the session cached for the host (session ID or ticket) so the server can skip
+// the key exchange. Every feed lives on its own host, so there is no connection
+// worth keeping open between requests - resumption is where the time goes.
+// Certificates are not verified - same as setInsecure() before.
+class ResumableTlsClient : public WiFiClient {
+public:
+    using WiFiClient::connect;
+    
+    ~ResumableTlsClient() { stop(); }
+    
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) override {
+        return connect(ip.toString().c_str(), port, timeout);
+    }
+    
+    int connect(const char* host, uint16_t port, int32_t timeout) override {
+        stop();
+        if (!_tcp.connect(host, port, timeout)) return 0;
+        
+        tlsRngInit();
+        mbedtls_ssl_init(&_ssl);
+        mbedtls_ssl_config_init(&_conf);
+        _open = true;
+        
+        if (mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT,
+                                        MBEDTLS_SSL_TRANSPORT_STREAM,
+                                        MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+            stop();
+            return 0;
+        }
+        mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_NONE);
+        mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &tlsDrbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+        if (mbedtls_ssl_setup(&_ssl, &_conf) != 0 ||
+            mbedtls_ssl_set_hostname(&_ssl, host) != 0) {
+            stop();
+            return 0;
+        }
+        mbedtls_ssl_set_bio(&_ssl, this, bioSend, bioRecv, NULL);
+        
+        TlsSessionSlot* slot = tlsSlotFor(host);
+        bool offered = slot->valid && mbedtls_ssl_set_session(&_ssl, &slot->session) == 0;
+        
+        // Non-blocking BIO: the handshake returns WANT_READ until the server's
+        // next flight is in. 0 means it is over - the context's state field is
+        // private from mbedTLS 3 on, so don't look at it.
+        unsigned long started = millis();
+        int ret;
+        while ((ret = mbedtls_ssl_handshake(&_ssl)) != 0) {
+            if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+                millis() - started > HTTP_TIMEOUT_MS) {
+                Serial.printf("[TLS] %s handshake failed: -0x%04X\n", host, -ret);
+                // Don't offer a session the server just choked on
+                if (slot->valid) {
+                    mbedtls_ssl_session_free(&slot->session);
+                    slot->valid = false;
+                }
+                stop();
+                return 0;
+            }
+            feed_watchdog();
+            delay(1);
+        }
+        
+        // What the server settled on - compared with what we offered, then
+        // kept (possibly new) for next time
+        mbedtls_ssl_session got;
+        mbedtls_ssl_session_init(&got);
+        bool gotSession = (mbedtls_ssl_get_session(&_ssl, &got) == 0);
+        bool fullHandshake = !offered || !gotSession || !tlsSameSession(slot->session, got);
+        slot->lastHandshakeMs = millis() - started;
+        if (fullHandshake) slot->handshakes++;
+        else slot->resumed++;
+        
+        if (slot->valid) mbedtls_ssl_session_free(&slot->session);
+        slot->session = got;            // The slot owns its ticket buffer now
+        slot->valid = gotSession;
+        if (!gotSession) mbedtls_ssl_session_free(&slot->session);
+        
+        Serial.printf("[TLS] %s %s in %u ms\n", host,
+                      fullHandshake ? "handshake" : "resumed", slot->lastHandshakeMs);
+        return 1;
+    }
+    
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!_open) return 0;
+        size_t sent = 0;
+        unsigned long started = millis();
+        while (sent < size) {
+            int ret = mbedtls_ssl_write(&_ssl, buf + sent, size - sent);
+            if (ret > 0) {
+                sent += ret;
+                continue;
+            }
+            if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+                millis() - started > HTTP_TIMEOUT_MS) {
+                stop();
+                break;
+            }
+            delay(1);
+        }
+        return sent;
+    }
+    
+    int available() override {
+        if (!_open) return 0;
+        int n = mbedtls_ssl_get_bytes_avail(&_ssl);
+        if (n == 0 && _tcp.available() > 0) {
+            // Decrypt the next record so its payload shows up as available
+            int ret = mbedtls_ssl_read(&_ssl, NULL, 0);
+            if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+                stop();
+                return _peeked >= 0 ? 1 : 0;
+            }
+            n = mbedtls_ssl_get_bytes_avail(&_ssl);
+        }
+        return n + (_peeked >= 0 ? 1 : 0);
+    }
+    
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    
+    int read(uint8_t* buf, size_t size) override {
+        if (size == 0) return 0;
+        int got = 0;
+        if (_peeked >= 0) {
+            buf[got++] = (uint8_t)_peeked;
+            _peeked = -1;
+            if (size == 1) return 1;
+        }
+        if (!_open || available() == 0) return got > 0 ? got : -1;
+        
+        int ret = mbedtls_ssl_read(&_ssl, buf + got, size - got);
+        if (ret > 0) return got + ret;
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            stop();  // 0 or close_notify = peer closed
+        }
+        return got > 0 ? got : -1;
+    }
+    
+    int peek() override {
+        if (_peeked < 0) _peeked = read();
+        return _peeked;
+    }
+    
+    // Throw away whatever is left of the response
+    void flush() override {
+        _peeked = -1;
+        uint8_t scrap[64];
+        while (available() > 0) {
+            if (read(scrap, sizeof(scrap)) <= 0) break;
+        }
+    }
+    
+    uint8_t connected() override {
+        if (_peeked >= 0) return 1;
+        if (!_open) return 0;
+        if (mbedtls_ssl_get_bytes_avail(&_ssl) > 0) return 1;
+        return _tcp.connected();
+    }
+    
+    void stop() override {
+        if (_open) {
+            mbedtls_ssl_close_notify(&_ssl);
+            mbedtls_ssl_free(&_ssl);
+            mbedtls_ssl_config_free(&_conf);
+            _open = false;
+        }
+        _tcp.stop();
+        _peeked = -1;
+    }
+    
+private:
+    static int bioSend(void* ctx, const unsigned char* buf, size_t len) {
+        WiFiClient& tcp = ((ResumableTlsClient*)ctx)->_tcp;
+        size_t n = tcp.write(buf, len);
+        return n > 0 ? (int)n : MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    
+    static int bioRecv(void* ctx, unsigned char* buf, size_t len) {
+        ResumableTlsClient* self = (ResumableTlsClient*)ctx;
+        int avail = self->_tcp.available();
+        if (avail <= 0) {
+            return self->_tcp.connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+        }
+        int n = self->_tcp.read(buf, min(len, (size_t)avail));
+        if (n <= 0) return MBEDTLS_ERR_SSL_WANT_READ;
+        return n;
+    }
+    
+    WiFiClient          _tcp;
+    mbedtls_ssl_context _ssl;
+    mbedtls_ssl_config  _conf;
+    bool                _open    = false;
+    int                 _peeked  = -1;
+};
+
+ResumableTlsClient tlsClient;  // Shared by all feeds, one request at a time
+
+// ==================== HTTP STREAMING ====================
+
+// Decodes a "Transfer-Encoding: chunked" body on the fly so the JSON parser
+// never sees the chunk-size lines. Nothing is buffered.
+class ChunkedStream : public Stream {
+public:
+    explicit ChunkedStream(Stream& src) : _src(src) {}
+    
+    int available() override {
+        if (_done) return 0;
+        int n = _src.available();
+        if (_left > 0 && n > (int)_left) n = _left;
+        return n;
+    }
+    
+    int read() override {
+        if (!fill()) return -1;
+        int c = readRaw();
+        if (c < 0) {
+            _done = true;
+            return -1;
+        }
+        _left--;
+        return c;
+    }
+    
+    int peek() override {
+        if (!fill()) return -1;
+        unsigned long start = millis();
+        while (!_src.available() && millis() - start < _timeout) delay(1);
+        return _src.peek();
+    }
+    
+    size_t write(uint8_t) override { return 0; }
+    
+    bool done() const { return _done; }
+    
+private:
+    Stream&  _src;
+    uint32_t _left    = 0;      // Bytes left in the current chunk
+    bool     _started = false;  // Seen at least one chunk header
+    bool     _done    = false;  // Hit the 0-size chunk or a read error
+    
+    int readRaw() {
+        char c;
+        return _src.readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+    }
+    
+    // Parse the next chunk header once the current chunk is used up
+    bool fill() {
+        if (_done) return false;
+        if (_left > 0) return true;
+        
+        int c;
+        if (_started) {
+            // Skip the CRLF that closes the previous chunk
+            while ((c = readRaw()) >= 0 && c != '\n') {}
+        }
+        _started = true;
+        
+        uint32_t size = 0;
+        bool extension = false;
+        while ((c = readRaw()) >= 0 && c != '\n') {
+            if (c == ';') extension = true;  // Chunk extensions are ignored
+            if (extension || c == '\r' || c == ' ') continue;
+            
+            int v;
+            if (c >= '0' && c <= '9') v = c - '0';
+            else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+            else { c = -1; break; }  // Not a chunk header - give up
+            size = (size << 4) | v;
+        }
+        
+        // 0-size chunk is the end of the body (trailers are not used)
+        if (c < 0 || size == 0) {
+            _done = true;
+            return false;
+        }
+        _left = size;
+        return true;
+    }
+};
+
+// *** GZIP - inflates a "Content-Encoding: gzip/deflate" body on the fly ***
+// Deflate may refer back up to 32KB, so the window can't be smaller than that.
+// It is allocated only while a compressed body is being read.
+#define INFLATE_IN_BUF      512
+#define INFLATE_MIN_HEAP    (TINFL_LZ_DICT_SIZE + sizeof(tinfl_decompressor) + 16384)
+
+class InflateStream : public Stream {
+public:
+    // gzip = true for a gzip member, false for a zlib ("deflate") stream
+    InflateStream(Stream& src, bool gzip) : _src(src), _gzip(gzip) {}
+    
+    ~InflateStream() {
+        free(_dict);
+        free(_inflator);
+    }
+    
+    // Allocates the window and skips the gzip header - false = can't decode
+    bool begin() {
+        _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+        _inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+        if (!_dict || !_inflator) {
+            Serial.println("[GZIP] ❌ No memory for the inflate window");
+            return false;
+        }
+        tinfl_init(_inflator);
+        return !_gzip || skipGzipHeader();
+    }
+    
+    int available() override {
+        if (_outPos < _outEnd) return _outEnd - _outPos;
+        return _done ? 0 : _src.available();
+    }
+    
+    int read() override {
+        if (_outPos == _outEnd && !inflateMore()) return -1;
+        return _dict[_outPos++];
+    }
+    
+    int peek() override {
+        if (_outPos == _outEnd && !inflateMore()) return -1;
+        return _dict[_outPos];
+    }
+    
+    size_t write(uint8_t) override { return 0; }
+    
+    uint32_t compressedBytes() const { return _compressed; }
+    bool failed() const { return _failed; }
+    
+private:
+    Stream&             _src;
+    bool                _gzip;
+    tinfl_decompressor* _inflator = nullptr;
+    uint8_t*            _dict     = nullptr;   // Circular window, also the output buffer
+    uint8_t             _in[INFLATE_IN_BUF];
+    size_t              _inPos = 0, _inLen = 0;
+    size_t              _dictOfs = 0;           // Where tinfl writes next
+    size_t              _outPos = 0, _outEnd = 0;  // Inflated bytes not yet read
+    uint32_t            _compressed = 0;
+    bool                _srcEnded = false;
+    bool                _done     = false;
+    bool                _failed   = false;
+    
+    int readRaw() {
+        char c;
+        if (_src.readBytes(&c, 1) != 1) return -1;
+        _compressed++;
+        return (uint8_t)c;
+    }
+    
+    bool skipBytes(size_t n) {
+        while (n--) if (readRaw() < 0) return false;
+        return true;
+    }
+    
+    bool skipString() {
+        int c;
+        while ((c = readRaw()) > 0) {}
+        return c == 0;
+    }
+    
+    // RFC 1952 member header: magic, method, flags, mtime, xfl, os + optional fields
+    bool skipGzipHeader() {
+        uint8_t h[10];
+        if (_src.readBytes((char*)h, sizeof(h)) != sizeof(h)) return false;
+        _compressed += sizeof(h);
+        if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) {
+            Serial.println("[GZIP] ❌ Not a gzip body");
+            _failed = true;
+            return false;
+        }
+        uint8_t flags = h[3];
+        if (flags & 0x04) {                      // FEXTRA
+            int lo = readRaw(), hi = readRaw();
+            if (lo < 0 || hi < 0 || !skipBytes(lo | (hi << 8))) return false;
+        }
+        if ((flags & 0x08) && !skipString()) return false;   // FNAME
+        if ((flags & 0x10) && !skipString()) return false;   // FCOMMENT
+        if ((flags & 0x02) && !skipBytes(2)) return false;   // FHCRC
+        return true;
+    }
+    
+    // Waits for at least one byte, then takes whatever else has already arrived
+    void refill() {
+        _inPos = _inLen = 0;
+        if (_src.readBytes((char*)_in, 1) != 1) {
+            _srcEnded = true;
+            return;
+        }
+        int more = min(_src.available(), (int)sizeof(_in) - 1);
+        _inLen = 1 + (more > 0 ? _src.readBytes((char*)_in + 1, more) : 0);
+    }
+    
+    bool inflateMore() {
+        if (!_dict || !_inflator) return false;
+        
+        while (!_done) {
+            if (_inPos == _inLen && !_srcEnded) refill();
+            
+            size_t inBytes  = _inLen - _inPos;
+            size_t outBytes = TINFL_LZ_DICT_SIZE - _dictOfs;
+            mz_uint32 flags = (_srcEnded ? 0 : TINFL_FLAG_HAS_MORE_INPUT) |
+                              (_gzip ? 0 : TINFL_FLAG_PARSE_ZLIB_HEADER);
+            tinfl_status st = tinfl_decompress(_inflator, _in + _inPos, &inBytes,
+                                               _dict, _dict + _dictOfs, &outBytes, flags);
+            _inPos += inBytes;
+            _compressed += inBytes;
+            
+            _outPos = _dictOfs;
+            _outEnd = _dictOfs + outBytes;
+            _dictOfs = (_dictOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+            
+            if (st < TINFL_STATUS_DONE) {
+                Serial.printf("[GZIP] ❌ Inflate error %d\n", (int)st);
+                _failed = true;
+                _done = true;
+            } else if (st == TINFL_STATUS_DONE) {
+                _done = true;   // The gzip trailer (CRC + size) is left unread
+            } else if (st == TINFL_STATUS_NEEDS_MORE_INPUT && _srcEnded) {
+                _failed = true; // Body cut short
+                _done = true;
+            }
+            if (outBytes > 0) return true;
+        }
+        return false;
+    }
+};
+
+// Counts body bytes on their way to the parser
+class CountingStream : public Stream {
+public:
+    explicit CountingStream(Stream& src) : _src(src) {}
+    
+    int available() override { return _src.available(); }
+    
+    int read() override {
+        char c;
+        if (_src.readBytes(&c, 1) != 1) return -1;
+        _count++;
+        return (uint8_t)c;
+    }
+    
+    int peek() override { return _src.peek(); }
+    size_t write(uint8_t) override { return 0; }
+    
+    uint32_t count() const { return _count; }
+    
+private:
+    Stream&  _src;
+    uint32_t _count = 0;
+};
+
+// Positions the stream just inside the JSON array stored under `key`
+bool jsonSeekArray(Stream& s, const char* key) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    return s.find(pattern) && s.find((char*)"[");
+}
+
+// Call after each array element: true if another element follows
+bool jsonNextElement(Stream& s) {
+    return s.findUntil((char*)",", (char*)"]");
+}
+
+// ==================== TIME HELPERS ====================
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static int32_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    int32_t yoe = y - era * 400;
+    int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// "2024-03-05T12:34:56.7Z" (UTC) -> epoch seconds, 0 if unparseable.
+// Feed timestamps are used as-is, so this works before NTP has synced.
+uint32_t parseIsoTime(const char* iso) {
+    int y, mo, d, h, mi, sec;
+    if (!iso || sscanf(iso, "%4d-%2d-%2dT%2d:%2d:%2d", &y, &mo, &d, &h, &mi, &sec) != 6) {
+        return 0;
+    }
+    if (y < 1970 || mo < 1 || mo > 12 || d < 1 || d > 31) return 0;
+    return (uint32_t)daysFromCivil(y, mo, d) * 86400UL + h * 3600UL + mi * 60UL + sec;
+}
+
+void formatIsoTime(uint32_t epoch, char* buf, size_t len) {
+    time_t t = epoch;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, len, "%Y-%m-%dT%H:%M:%S", &tm);
+}
+
+// ==================== FEED SOURCES ====================
+
+#define FEED_MAX_EVENTS_PER_ITEM 3   // NOAA scales yields G, S and R from one object
+
+// One entry per disaster feed - fetchFeed() does the rest
+struct FeedSource {
+    const char* tag;            // Log prefix, e.g. "USGS"
+    const char* url;
+    const char* accept;         // Accept header, NULL = none
+    const char* userAgent;      // NULL = DEFAULT_USER_AGENT
+    const char* arrayKey;       // Top-level array holding the items, NULL = whole document
+    const char* sinceParam;     // FDSN parameter set to the high-water time, NULL = static URL
+    const char* filter;         // ArduinoJson filter applied to each item
+    uint8_t     maxItems;       // Stop reading after this many items
+    uint32_t    intervalMs;     // Base poll interval - the scheduler adapts around it
+    uint16_t    seenTtlH;       // How long a seen ID is kept - the feed's own window
+    int       (*map)(JsonObject item, FeedEvent* out);   // Returns events written to out[]
+    uint8_t   (*alertLevel)(const FeedEvent* evt);      // NULL = mapper sets alertLevel
+};
+
+struct FeedStats {
+    uint32_t fetches;
+    uint32_t errors;
+    uint32_t items;
+    uint32_t newEvents;
+    int      lastHttp;
+    uint32_t lastMs;
+    uint32_t changed;       // 200 responses
+    uint32_t notModified;   // 304 responses - nothing downloaded or parsed
+    uint32_t bytesWire;     // Body bytes downloaded (compressed when gzipped)
+    uint32_t bytesRead;     // Body bytes parsed (after inflating)
+    uint32_t gzipped;       // 200 responses that came compressed
+    uint32_t bytesSaved;    // Estimated from the last full body size
+    uint32_t lastBodyBytes;
+};
+
+// ----- Adaptive polling -----
+
+#define FEED_BACKOFF_MAX_MS     (60UL * 60UL * 1000UL)  // Failing source: at most 1 hour between tries
+#define FEED_BACKOFF_MAX_SHIFT  8
+#define FEED_IDLE_GROWTH_PCT    150                     // Unchanged source: interval x1.5 ...
+#define FEED_IDLE_MAX_FACTOR    4                       // ... up to 4x its base interval
+#define FEED_BURST_INTERVAL_MS  (60UL * 1000UL)         // After a new red event poll every minute ...
+#define FEED_BURST_DURATION_MS  (30UL * 60UL * 1000UL)  // ... for 30 minutes (aftershocks)
+#define FEED_LOW_MEM_RETRY_MS   (60UL * 1000UL)
+#define FEED_JITTER_PCT         20
+
+enum FeedResult {
+    FEED_CHANGED,       // New content
+    FEED_UNCHANGED,     // 304, or the same item IDs as last time
+    FEED_FAILED,        // HTTP error, timeout or unparseable body
+    FEED_SKIPPED,       // Not attempted (low memory)
+};
+
+struct FeedSchedule {
+    uint32_t nextDueMs;     // 0 = due now
+    uint32_t intervalMs;    // Current interval while healthy, 0 = base
+    uint32_t burstUntilMs;  // Polling fast until then, 0 = no burst
+    uint8_t  failures;      // Consecutive failures, drives the backoff
+    uint32_t itemsHash;     // XOR of item ID hashes from the last good fetch
+    uint32_t redHash;       // Same, red-level events only
+    uint32_t pendingHash;   // Being accumulated by the fetch in progress
+    uint32_t pendingRedHash;
+    uint32_t pendingHighWater;
+    uint16_t pageOffset;    // Items already read from a since-window that came back full
+    uint32_t pageHighWater; // Newest time across those pages
+};
+
+// Validators from the last good response, sent back as a conditional GET
+struct FeedValidator {
+    char etag[72];
+    char lastModified[40];  // "Wed, 21 Oct 2015 07:28:00 GMT"
+};
+
+#define DEFAULT_USER_AGENT "DisasterAlert/2.4 ESP32"
+
+// ----- Alert level rules -----
+
+uint8_t alertByQuakeMag(const FeedEvent* evt) {
+    if (evt->magnitude >= 7.0) return 2;
+    if (evt->magnitude >= 5.5) return 1;
+    return 0;
+}
+
+// NOAA G/S/R scales 1-5
+uint8_t alertByScale(const FeedEvent* evt) {
+    if (evt->magnitude >= 4) return 2;
+    if (evt->magnitude >= 2) return 1;
+    return 0;
+}
+
+uint8_t alertByType(const FeedEvent* evt) { return getEventTypeAlertLevel(evt->type); }
+uint8_t alertRed(const FeedEvent*)    { return 2; }
+
+// ----- Field mappers -----
+
+// GeoJSON point is [lon, lat, depth]
+static void mapQuakeOrigin(JsonObject feature, uint32_t originTime, FeedEvent* out) {
+    JsonArray coords = feature["geometry"]["coordinates"];
+    if (coords.size() < 2 || originTime == 0) return;
+    out->lon = coords[0] | 0.0f;
+    out->lat = coords[1] | 0.0f;
+    out->originTime = originTime;
+}
+
+// Where a GeoJSON geometry is: the point itself, or the mean of a line's or
+// polygon's outer ring (first polygon of a multi). Good enough for a map dot.
+// False when the feed gave no geometry.
+static bool mapGeometry(JsonObject geometry, FeedEvent* out) {
+    JsonArray ring = geometry["coordinates"];
+    while (ring.size() > 0 && ring[0].is<JsonArray>() && ring[0][0].is<JsonArray>()) {
+        ring = ring[0];             // Multi-polygon -> polygon -> outer ring
+    }
+    if (ring.size() == 0) return false;
+    
+    if (!ring[0].is<JsonArray>()) {   // [lon, lat]
+        if (ring.size() < 2) return false;
+        out->lon = ring[0] | 0.0f;
+        out->lat = ring[1] | 0.0f;
+        return true;
+    }
+    
+    // A closed ring repeats its first point last - don't count it twice
+    int n = ring.size();
+    JsonArray first = ring[0];
+    JsonArray last = ring[n - 1];
+    if (n > 1 && first[0].as<float>() == last[0].as<float>() &&
+        first[1].as<float>() == last[1].as<float>()) n--;
+    
+    // Iterate, don't index - ring[i] walks the array from the start every time
+    float lon = 0, lat = 0;
+    int i = 0;
+    for (JsonArray pt : ring) {
+        if (i++ == n) break;
+        lon += pt[0] | 0.0f;
+        lat += pt[1] | 0.0f;
+    }
+    out->lon = lon / n;
+    out->lat = lat / n;
+    return true;
+}
+
+int mapUSGS(JsonObject feature, FeedEvent* out) {
+    const char* id = feature["id"] | "unknown";
+    snprintf(out->id, sizeof(out->id), "usgs_%s", id);
+    out->type = EventType::Quake;
+    
+    JsonObject props = feature["properties"];
+    out->magnitude = props["mag"] | 0.0f;
+    out->feedTime = (uint32_t)(props["updated"].as<double>() / 1000.0);  // epoch ms
+    mapQuakeOrigin(feature, (uint32_t)(props["time"].as<double>() / 1000.0), out);
+    const char* place = props["place"] | "Unknown";
+    const char* of = strstr(place, " of ");
+    strncpy(out->location, of ? (of + 4) : place, sizeof(out->location) - 1);
+    return 1;
+}
+
+int mapEMSC(JsonObject feature, FeedEvent* out) {
+    JsonObject props = feature["properties"];
+    out->feedTime = parseIsoTime(props["time"] | "");
+    mapQuakeOrigin(feature, out->feedTime, out);
+    
+    // Get unique ID
+    const char* unid = props["unid"] | "";
+    if (strlen(unid) > 0) {
+        snprintf(out->id, sizeof(out->id), "emsc_%s", unid);
+    } else {
+        snprintf(out->id, sizeof(out->id), "emsc_%lu", (unsigned long)out->feedTime);
+    }
+    
+    out->type = EventType::Quake;
+    out->magnitude = props["mag"] | 0.0f;
+    
+    // flynn_region is the readable location name
+    const char* region = props["flynn_region"] | "Unknown";
+    strncpy(out->location, region, sizeof(out->location) - 1);
+    return 1;
+}
+
+int mapEONET(JsonObject event, FeedEvent* out) {
+    const char* id = event["id"] | "unknown";
+    snprintf(out->id, sizeof(out->id), "eonet_%s", id);
+    
+    // Category (fire, storm, volcano, etc.)
+    JsonArray categories = event["categories"];
+    if (categories.size() > 0) {
+        const char* catId = categories[0]["id"] | "unknown";
+        out->type = parseEventType(catId);
+    } else {
+        out->type = EventType::Alert;
+    }
+    
+    const char* title = event["title"] | "Unknown Event";
+    strncpy(out->location, title, sizeof(out->location) - 1);
+    
+    // One geometry per observation, oldest first - the last is where it is now
+    JsonArray track = event["geometry"];
+    if (track.size() > 0) mapGeometry(track[track.size() - 1], out);
+    
+    // EONET doesn't have magnitude
+    out->magnitude = 0;
+    return 1;
+}
+
+// noaa-scales.json: {"0": {"DateStamp": "...", "R": {"Scale": "0"}, "S": {...}, "G": {...}}}
+// R = Radio Blackout, S = Solar Radiation, G = Geomagnetic Storm
+// Scale: 0=none, 1=minor, 2=moderate, 3=strong, 4=severe, 5=extreme
+int mapSpaceWeather(JsonObject doc, FeedEvent* out) {
+    static const struct {
+        const char* key;
+        EventType   type;
+        const char* name;
+    } scales[] = {
+        { "G", EventType::Geomag, "Geomagnetic Storm" },
+        { "S", EventType::Solar,  "Solar Radiation" },
+        { "R", EventType::Radio,  "Radio Blackout" },
+    };
+    
+    JsonObject day0 = doc["0"];
+    if (day0.isNull()) {
+        Serial.println("[SPACE] No current data in response");
+        return 0;
+    }
+    const char* dateStamp = day0["DateStamp"] | "now";
+    
+    int n = 0;
+    for (const auto& s : scales) {
+        // Scales are sent as strings - as<int>() parses them, "| 0" would not
+        int level = day0[s.key]["Scale"].as<int>();
+        if (level < 1) continue;
+        
+        FeedEvent* evt = &out[n++];
+        snprintf(evt->id, sizeof(evt->id), "noaa_%s_%s", s.key, dateStamp);
+        evt->type = s.type;
+        snprintf(evt->location, sizeof(evt->location), "%s %s%d", s.name, s.key, level);
+        evt->magnitude = level;
+    }
+    return n;
+}
+
+int mapNWS(JsonObject feature, FeedEvent* out) {
+    JsonObject props = feature["properties"];
+    
+    // Get ID (use last 16 chars)
+    const char* id = props["id"] | "";
+    snprintf(out->id, sizeof(out->id), "nws_%.16s", id + (strlen(id) > 16 ? strlen(id) - 16 : 0));
+    
+    // Map event name to our types
+    const char* eventName = props["event"] | "Alert";
+    if (strstr(eventName, "Tornado") != NULL) {
+        out->type = EventType::Tornado;
+    } else if (strstr(eventName, "Hurricane") != NULL) {
+        out->type = EventType::Cyclone;
+    } else if (strstr(eventName, "Tsunami") != NULL) {
+        out->type = EventType::Tsunami;
+    } else if (strstr(eventName, "Flash Flood") != NULL) {
+        out->type = EventType::Flood;
+    } else if (strstr(eventName, "Fire") != NULL) {
+        out->type = EventType::Wildfire;
+    } else {
+        out->type = EventType::Extreme;
+    }
+    
+    // Headline - the display layout wraps, ellipsizes or scrolls it
+    const char* headline = props["headline"] | eventName;
+    size_t cap = sizeof(out->location) - 1;
+    strncpy(out->location, headline, cap);
+    out->location[cap] = '\0';
+    if (strlen(headline) > cap) {
+        strcpy(out->location + cap - 3, "...");   // Mark what the field couldn't hold
+    }
+    
+    // Polygon alerts have a geometry; zone-based ones come with null
+    mapGeometry(feature["geometry"], out);
+    
+    out->magnitude = 0;
+    return 1;
+}
+
+int mapGDACS(JsonObject feature, FeedEvent* out) {
+    JsonObject props = feature["properties"];
+    
+    // eventtype is already one of our codes: EQ, TC, FL, VO, DR, WF
+    const char* type = props["eventtype"] | "";
+    snprintf(out->id, sizeof(out->id), "gdacs_%s%ld", type, props["eventid"].as<long>());
+    out->type = parseEventType(type);
+    
+    const char* country = props["country"] | "";
+    const char* name = props["name"] | "Unknown";
+    strncpy(out->location, strlen(country) > 0 ? country : name, sizeof(out->location) - 1);
+    mapGeometry(feature["geometry"], out);
+    
+    // Severity is the magnitude for quakes, wind speed/area/etc. for the rest
+    out->magnitude = (out->type == EventType::Quake) ? (props["severitydata"]["severity"] | 0.0f) : 0;
+    
+    const char* level = props["alertlevel"] | "Green";
+    if (strcasecmp(level, "Red") == 0) out->alertLevel = 2;
+    else if (strcasecmp(level, "Orange") == 0) out->alertLevel = 1;
+    else out->alertLevel = 0;
+    return 1;
+}
+
+// ----- Registry -----
+
+const FeedSource FEEDS[] = {
+    // Seen IDs are kept for: quakes 2 days (revisions trickle in), space
+    // weather a day and a half (one entry per day), NWS 3 days, and the
+    // long-running EONET/GDACS events as long as the stamp allows.
+    
+    // Earthquakes (US)
+    // Only events updated since the newest one we have
+    { "USGS", USGS_URL, NULL, NULL, "features", "updatedafter",
+      "{\"id\":true,\"geometry\":{\"coordinates\":true},"
+      "\"properties\":{\"mag\":true,\"place\":true,\"time\":true,\"updated\":true}}",
+      5, FETCH_INTERVAL_MS, 48, mapUSGS, alertByQuakeMag },
+    
+    // Earthquakes (Europe/World)
+    // Only events newer than the newest one we have
+    { "EMSC", EMSC_URL, "application/json", NULL, "features", "starttime",
+      "{\"geometry\":{\"coordinates\":true},"
+      "\"properties\":{\"unid\":true,\"time\":true,\"mag\":true,\"flynn_region\":true}}",
+      5, FETCH_INTERVAL_MS, 48, mapEMSC, alertByQuakeMag },
+    
+    // NASA events (fires, storms, volcanoes) - level from the type table, orange for these
+    { "EONET", EONET_URL, NULL, NULL, "events", NULL,
+      "{\"id\":true,\"title\":true,\"categories\":[{\"id\":true}],"
+      "\"geometry\":[{\"coordinates\":true}]}",
+      5, 3 * FETCH_INTERVAL_MS, SEEN_TTL_MAX_H, mapEONET, alertByType },
+    
+    // Space weather (solar flares, geomagnetic storms) - only today's entry
+    { "SPACE", NOAA_SPACE_URL, NULL, NULL, NULL, NULL,
+      "{\"0\":{\"DateStamp\":true,\"G\":{\"Scale\":true},\"S\":{\"Scale\":true},\"R\":{\"Scale\":true}}}",
+      1, 6 * FETCH_INTERVAL_MS, 36, mapSpaceWeather, alertByScale },
+    
+    // NWS Severe Weather Alerts (Tornadoes, Hurricanes, etc) - all Extreme
+    { "NWS", NWS_ALERTS_URL, "application/geo+json", "(DisasterAlert/2.4, github.com/disaster-alert)",
+      "features", NULL,
+      "{\"geometry\":{\"coordinates\":true},"
+      "\"properties\":{\"id\":true,\"event\":true,\"headline\":true}}",
+      NWS_MAX_ALERTS, FETCH_INTERVAL_MS, 72, mapNWS, alertRed },
+    
+    // GDACS multi-hazard (cyclones, floods, volcanoes, droughts) - level from feed
+    { "GDACS", GDACS_URL, "application/json", NULL, "features", NULL,
+      "{\"geometry\":{\"coordinates\":true},"
+      "\"properties\":{\"eventtype\":true,\"eventid\":true,\"name\":true,\"country\":true,"
+      "\"alertlevel\":true,\"severitydata\":{\"severity\":true}}}",
+      5, 3 * FETCH_INTERVAL_MS, SEEN_TTL_MAX_H, mapGDACS, NULL },
+};
+#define FEED_COUNT (sizeof(FEEDS) / sizeof(FEEDS[0]))
+
+uint16_t feedSeenTtlHours(uint8_t source) {
+    return source < FEED_COUNT ? FEEDS[source].seenTtlH : SEEN_TTL_MAX_H;
+}
+
+FeedStats     feedStats[FEED_COUNT];
+FeedValidator feedValidators[FEED_COUNT];
+FeedSchedule  feedSchedules[FEED_COUNT];
+uint32_t      feedHighWater[FEED_COUNT];    // Newest feedTime ingested per source (epoch s)
+
+uint32_t getFeedHighWater(int idx) {
+    return (idx >= 0 && idx < (int)FEED_COUNT) ? feedHighWater[idx] : 0;
 }
 
-// ==================== EVENT TRACKING ====================
+void setFeedHighWater(int idx, uint32_t t) {
+    if (idx >= 0 && idx < (int)FEED_COUNT) feedHighWater[idx] = t;
+}
 
-bool isEventSeen(const char* id) {
-    for (int i = 0; i < seenCount; i++) {
-        if (strcmp(seenEvents[i], id) == 0) return true;
+// Forget validators and high-water marks so the next fetch downloads everything again
+void resetFeedCaches() {
+    memset(feedValidators, 0, sizeof(feedValidators));
+    memset(feedHighWater, 0, sizeof(feedHighWater));
+    for (size_t i = 0; i < FEED_COUNT; i++) {
+        feedSchedules[i].pageOffset = 0;
+        feedSchedules[i].pageHighWater = 0;
     }
-    return false;
 }
 
-void markEventSeen(const char* id) {
-    if (isEventSeen(id)) return;
-    
-    strncpy(seenEvents[seenIndex], id, ID_LENGTH - 1);
-    seenEvents[seenIndex][ID_LENGTH - 1] = '\0';
-    seenIndex = (seenIndex + 1) % MAX_EVENTS;
-    if (seenCount < MAX_EVENTS) seenCount++;
-    
-    Serial.printf("[SEEN] %s (total:%d)\n", id, seenCount);
-    
-    // *** REDUCED SAVE FREQUENCY ***
-    // Only save every 10 events instead of 5
-    static int n = 0;
-    if (++n >= 10) {
-        eeprom_save();
-        n = 0;
+// A since-window read oldest first that comes back full may hold more: keep
+// the window where it is and read the next page, and only move the mark once
+// a page comes back short. USGS filters on update time but sorts on origin
+// time, so the page's newest time is no safe mark on its own.
+void advanceHighWater(int idx, bool fullPage) {
+    FeedSchedule& sch = feedSchedules[idx];
+    sch.pageHighWater = max(sch.pageHighWater, sch.pendingHighWater);
+    if (fullPage && feedHighWater[idx] != 0) {
+        sch.pageOffset += FEEDS[idx].maxItems;
+        Serial.printf("[%s] Window full - next page at %u\n", FEEDS[idx].tag, (unsigned)sch.pageOffset);
+        return;
     }
+    if (sch.pageHighWater > feedHighWater[idx]) feedHighWater[idx] = sch.pageHighWater;
+    sch.pageOffset = 0;
+    sch.pageHighWater = 0;
 }
 
-bool addToQueue(DisasterEvent* evt) {
-    if (isEventSeen(evt->id)) return false;
-    
-    if (queueCount >= 5) {
-        queueHead = (queueHead + 1) % 5;
-        queueCount--;
+void storeValidator(char* dst, size_t len, const String& value) {
+    // A truncated validator would never match - don't keep it
+    if (value.length() >= len) {
+        dst[0] = '\0';
+        return;
     }
-    
-    memcpy(&displayQueue[queueTail], evt, sizeof(DisasterEvent));
-    queueTail = (queueTail + 1) % 5;
-    queueCount++;
-    
-    const char* typeName = getEventTypeName(evt->type);
-    Serial.printf("[QUEUE] %s %s (q:%d)\n", typeName, evt->location, queueCount);
-    
-    // Format LoRa message based on event type
-    char msg[80];
-    if (evt->magnitude > 0) {
-        snprintf(msg, sizeof(msg), "%s M%.1f %s", typeName, evt->magnitude, evt->location);
-    } else {
-        snprintf(msg, sizeof(msg), "%s %s", typeName, evt->location);
+    strcpy(dst, value.c_str());
+}
+
+// ==================== FETCH -> UI HANDOFF ====================
+
+#define FETCH_EVENT_QUEUE_LEN 8
+#define FETCH_CYCLE_DONE      0xFF   // FetchedEvent.source marking the end of a cycle
+
+// Events travel from the fetch task (core 0) to loop() (core 1) by value, so
+// the display queue, LoRa queue and seen-set stay owned by loop() alone
+struct FetchedEvent {
+    FeedEvent evt;
+    uint8_t   source;       // Index into FEEDS[], or FETCH_CYCLE_DONE
+};
+
+SpscRing<FetchedEvent, FETCH_EVENT_QUEUE_LEN> fetchedEvents;
+
+void postFetchedEvent(const FeedEvent* evt, uint8_t source) {
+    FetchedEvent fe;
+    if (evt) fe.evt = *evt;
+    else memset(&fe.evt, 0, sizeof(fe.evt));
+    fe.source = source;
+    
+    // Wait for loop() to catch up rather than dropping events
+    while (!fetchedEvents.push(fe)) {
+        feed_watchdog();
+        vTaskDelay(pdMS_TO_TICKS(20));
     }
-    queueLoraMessage(msg);
-    
-    return true;
 }
 
-bool getFromQueue(DisasterEvent* evt) {
-    if (queueCount == 0) return false;
-    
-    memcpy(evt, &displayQueue[queueHead], sizeof(DisasterEvent));
-    queueHead = (queueHead + 1) % 5;
-    queueCount--;
-    markEventSeen(evt->id);
-    
-    return true;
+// ==================== FEED SCHEDULER ====================
+
+// Spread retries so sources (and devices) don't fire in lockstep
+uint32_t withJitter(uint32_t ms) {
+    uint32_t span = ms / 100 * FEED_JITTER_PCT;
+    if (span == 0) return ms;
+    return ms - span + esp_random() % (2 * span + 1);
 }
 
-// ==================== FETCH ====================
+bool isFeedDue(int idx) {
+    return (int32_t)(millis() - feedSchedules[idx].nextDueMs) >= 0;
+}
 
-int fetchUSGS() {
-    // *** MEMORY CHECK BEFORE FETCH ***
-    if (!is_memory_safe()) {
-        Serial.println("[USGS] ❌ Skipping fetch - low memory");
-        return 0;
+void scheduleFeed(int idx, FeedResult result) {
+    FeedSchedule& sch = feedSchedules[idx];
+    uint32_t base = FEEDS[idx].intervalMs;
+    uint32_t now = millis();
+    uint32_t interval;
+    
+    if (sch.intervalMs == 0) sch.intervalMs = base;
+    
+    switch (result) {
+        case FEED_FAILED:
+            // Exponential backoff - and no burst, don't hammer a failing server
+            if (sch.failures < FEED_BACKOFF_MAX_SHIFT) sch.failures++;
+            interval = min(base << (sch.failures - 1), (uint32_t)FEED_BACKOFF_MAX_MS);
+            sch.nextDueMs = now + withJitter(interval);
+            Serial.printf("[SCHED] %s failed %d time(s), retry in %us\n",
+                          FEEDS[idx].tag, sch.failures, (sch.nextDueMs - now) / 1000);
+            return;
+            
+        case FEED_SKIPPED:
+            sch.nextDueMs = now + FEED_LOW_MEM_RETRY_MS;
+            return;
+            
+        case FEED_CHANGED:
+            sch.failures = 0;
+            sch.intervalMs = base;
+            break;
+            
+        case FEED_UNCHANGED:
+            // Slow down sources that keep returning the same thing
+            sch.failures = 0;
+            sch.intervalMs = min(sch.intervalMs / 100 * FEED_IDLE_GROWTH_PCT,
+                                 base * FEED_IDLE_MAX_FACTOR);
+            break;
     }
     
-    Serial.println("[USGS] Fetching earthquakes...");
-    Serial.printf("[MEM] Free: %u bytes\n", ESP.getFreeHeap());
-    
-    feed_watchdog();
-    
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
-    http.begin(client, USGS_URL);
-    http.setTimeout(15000);
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    
-    int httpCode = http.GET();
-    int newEvents = 0;
-    Serial.printf("[USGS] HTTP %d\n", httpCode);
-    
-    feed_watchdog();
-    
-    if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
-        Serial.printf("[USGS] Received %d bytes\n", payload.length());
-        
-        // *** CHECK PAYLOAD SIZE ***
-        if (payload.length() > MAX_JSON_SIZE) {
-            Serial.println("[USGS] ❌ Payload too large, skipping");
-            http.end();
-            return 0;
-        }
-        
-        feed_watchdog();
-        
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        
-        // Free payload memory immediately
-        payload = String();
-        
-        if (error) {
-            Serial.printf("[USGS] JSON error: %s\n", error.c_str());
+    interval = sch.intervalMs;
+    if (sch.pageOffset) interval = min(interval, (uint32_t)FEED_BURST_INTERVAL_MS);   // Next page soon
+    if (sch.burstUntilMs != 0) {
+        if ((int32_t)(now - sch.burstUntilMs) < 0) {
+            interval = min(interval, (uint32_t)FEED_BURST_INTERVAL_MS);
         } else {
-            JsonArray features = doc["features"];
-            Serial.printf("[USGS] Parsed %d quakes\n", features.size());
-            
-            int count = 0;
-            for (JsonObject feature : features) {
-                if (++count > 5) break;
-                
-                feed_watchdog();
-                
-                DisasterEvent evt;
-                memset(&evt, 0, sizeof(evt));
-                
-                const char* id = feature["id"] | "unknown";
-                snprintf(evt.id, sizeof(evt.id), "usgs_%s", id);
-                strcpy(evt.type, "EQ");  // Earthquake
-                
-                JsonObject props = feature["properties"];
-                evt.magnitude = props["mag"] | 0.0f;
-                const char* place = props["place"] | "Unknown";
-                const char* of = strstr(place, " of ");
-                strncpy(evt.location, of ? (of + 4) : place, sizeof(evt.location) - 1);
-                
-                if (evt.magnitude >= 7.0) evt.alertLevel = 2;
-                else if (evt.magnitude >= 5.5) evt.alertLevel = 1;
-                else evt.alertLevel = 0;
-                
-                if (addToQueue(&evt)) newEvents++;
-            }
+            sch.burstUntilMs = 0;
+            Serial.printf("[SCHED] %s burst over\n", FEEDS[idx].tag);
         }
-    } else {
-        Serial.printf("[USGS] HTTP error: %d\n", httpCode);
     }
-    
-    http.end();
-    feed_watchdog();
-    
-    Serial.printf("[USGS] %d new quakes\n", newEvents);
-    return newEvents;
+    sch.nextDueMs = now + withJitter(interval);
 }
 
-// ==================== FETCH GDACS (Multi-hazard) ====================
-
-int fetchEMSC() {
-    if (!is_memory_safe()) {
-        Serial.println("[EMSC] ❌ Skipping - low memory");
-        return 0;
+// Compare this fetch's fingerprints with the last one
+FeedResult classifyFetch(int idx) {
+    FeedSchedule& sch = feedSchedules[idx];
+    
+    // A red event we haven't seen from this source - poll it fast for a while
+    if (sch.pendingRedHash != 0 && sch.pendingRedHash != sch.redHash) {
+        sch.burstUntilMs = millis() + FEED_BURST_DURATION_MS;
+        if (sch.burstUntilMs == 0) sch.burstUntilMs = 1;
+        Serial.printf("[SCHED] %s red event - burst polling for %lu min\n",
+                      FEEDS[idx].tag, FEED_BURST_DURATION_MS / 60000);
     }
+    sch.redHash = sch.pendingRedHash;
     
-    Serial.println("[EMSC] Fetching Euro earthquakes...");
-    feed_watchdog();
-    
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
-    http.begin(client, EMSC_URL);
-    http.setTimeout(15000);
-    http.addHeader("Accept", "application/json");
-    http.addHeader("User-Agent", "DisasterAlert/2.3 ESP32");
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    
-    int httpCode = http.GET();
-    int newEvents = 0;
-    Serial.printf("[EMSC] HTTP %d\n", httpCode);
-    
-    feed_watchdog();
-    
-    if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
-        Serial.printf("[EMSC] Received %d bytes\n", payload.length());
+    bool same = (sch.pendingHash == sch.itemsHash);
+    sch.itemsHash = sch.pendingHash;
+    return same ? FEED_UNCHANGED : FEED_CHANGED;
+}
+
+// ==================== FETCH ====================
+
+// Map one parsed item and hand the resulting events to loop()
+int ingestFeedItem(int idx, JsonObject item) {
+    const FeedSource& src = FEEDS[idx];
+    FeedEvent out[FEED_MAX_EVENTS_PER_ITEM];
+    memset(out, 0, sizeof(out));
+    
+    int n = src.map(item, out);
+    for (int i = 0; i < n; i++) {
+        if (src.alertLevel) out[i].alertLevel = src.alertLevel(&out[i]);
+        out[i].source = idx;
         
-        if (payload.length() > MAX_JSON_SIZE) {
-            Serial.println("[EMSC] ❌ Payload too large");
-            http.end();
-            return 0;
+        // Fingerprint what the feed returned so the scheduler can tell "nothing new"
+        uint32_t h = fnv1a32(out[i].id);
+        feedSchedules[idx].pendingHash ^= h;
+        if (out[i].alertLevel == 2) feedSchedules[idx].pendingRedHash ^= h;
+        if (out[i].feedTime > feedSchedules[idx].pendingHighWater) {
+            feedSchedules[idx].pendingHighWater = out[i].feedTime;
         }
         
-        feed_watchdog();
-        
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        payload = String();
-        
-        if (error) {
-            Serial.printf("[EMSC] JSON error: %s\n", error.c_str());
-        } else {
-            // EMSC uses "features" array like GeoJSON
-            JsonArray features = doc["features"];
-            Serial.printf("[EMSC] Parsed %d quakes\n", features.size());
-            
-            int count = 0;
-            for (JsonObject feature : features) {
-                if (++count > 5) break;
-                feed_watchdog();
-                
-                DisasterEvent evt;
-                memset(&evt, 0, sizeof(evt));
-                
-                JsonObject props = feature["properties"];
-                
-                // Get unique ID
-                const char* unid = props["unid"] | "";
-                if (strlen(unid) > 0) {
-                    snprintf(evt.id, sizeof(evt.id), "emsc_%s", unid);
-                } else {
-                    snprintf(evt.id, sizeof(evt.id), "emsc_%ld", (long)props["time"]);
-                }
-                
-                strcpy(evt.type, "EQ");
-                
-                // Get magnitude
-                evt.magnitude = props["mag"] | 0.0f;
-                
-                // Get location (flynn_region is the readable location name)
-                const char* region = props["flynn_region"] | "Unknown";
-                strncpy(evt.location, region, sizeof(evt.location) - 1);
-                
-                // Set alert level based on magnitude
-                if (evt.magnitude >= 7.0) evt.alertLevel = 2;
-                else if (evt.magnitude >= 5.5) evt.alertLevel = 1;
-                else evt.alertLevel = 0;
-                
-                if (addToQueue(&evt)) newEvents++;
-            }
-        }
-    } else {
-        Serial.printf("[EMSC] HTTP error: %d\n", httpCode);
+        postFetchedEvent(&out[i], idx);
     }
-    
-    http.end();
-    feed_watchdog();
-    
-    Serial.printf("[EMSC] %d new quakes\n", newEvents);
-    return newEvents;
+    return n;
 }
 
-// ==================== FETCH NASA EONET (Fires, Storms, Volcanoes) ====================
-
-int fetchEONET() {
+FeedResult fetchFeed(int idx) {
+    const FeedSource& src = FEEDS[idx];
+    FeedStats& stats = feedStats[idx];
+    FeedValidator& validator = feedValidators[idx];
+    
+    // *** MEMORY CHECK BEFORE FETCH ***
     if (!is_memory_safe()) {
-        Serial.println("[EONET] ❌ Skipping - low memory");
-        return 0;
+        Serial.printf("[%s] ❌ Skipping - low memory\n", src.tag);
+        return FEED_SKIPPED;
     }
     
-    Serial.println("[EONET] Fetching NASA events...");
+    Serial.printf("[%s] Fetching...\n", src.tag);
     feed_watchdog();
+    unsigned long started = millis();
+    FeedResult result = FEED_FAILED;
+    feedSchedules[idx].pendingHash = 0;
+    feedSchedules[idx].pendingRedHash = 0;
+    feedSchedules[idx].pendingHighWater = 0;
+    
+    // *** INCREMENTAL QUERY - only ask for what's newer than we already have ***
+    // Oldest first, so a full page is followed by the next one rather than
+    // hiding what didn't fit. With no mark yet, the newest are what we want.
+    char url[224];
+    if (src.sinceParam && feedHighWater[idx] != 0) {
+        char since[24];
+        formatIsoTime(feedHighWater[idx], since, sizeof(since));
+        int n = snprintf(url, sizeof(url), "%s&orderby=time-asc&%s=%s", src.url, src.sinceParam, since);
+        if (feedSchedules[idx].pageOffset) {
+            snprintf(url + n, sizeof(url) - n, "&offset=%u", (unsigned)feedSchedules[idx].pageOffset + 1);
+        }
+    } else if (src.sinceParam) {
+        snprintf(url, sizeof(url), "%s&orderby=time", src.url);
+    } else {
+        strncpy(url, src.url, sizeof(url) - 1);
+        url[sizeof(url) - 1] = '\0';
+    }
     
-    WiFiClientSecure client;
-    client.setInsecure();
+    // No two feeds share a host - close after each request and free the
+    // mbedTLS buffers; the session cache makes the next connect cheap. Even a
+    // feed's next page is a scheduler pass (FEED_BURST_INTERVAL_MS) away, with
+    // other hosts in between - longer than servers hold an idle keep-alive.
     HTTPClient http;
-    http.begin(client, EONET_URL);
-    http.setTimeout(15000);
-    http.addHeader("User-Agent", "DisasterAlert/2.3 ESP32");
+    http.setReuse(false);
+    http.begin(tlsClient, url);
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    http.setUserAgent(src.userAgent ? src.userAgent : DEFAULT_USER_AGENT);
+    if (src.accept) http.addHeader("Accept", src.accept);
     http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
     
+    // *** CONDITIONAL GET - a 304 costs no download and no parse ***
+    if (validator.etag[0]) http.addHeader("If-None-Match", validator.etag);
+    if (validator.lastModified[0]) http.addHeader("If-Modified-Since", validator.lastModified);
+    
+    // *** COMPRESSION - only ask for gzip when the inflate window will fit ***
+    // HTTPClient adds "Accept-Encoding: identity;q=1,..." to every HTTP/1.1
+    // request, and a second header would contradict it. It leaves it out in
+    // HTTP/1.0 mode - we close after each request anyway, and the chunked
+    // decoder is simply not needed then.
+    if (ESP.getMaxAllocHeap() >= TINFL_LZ_DICT_SIZE &&
+        ESP.getFreeHeap() >= MIN_FREE_HEAP + INFLATE_MIN_HEAP) {
+        http.useHTTP10(true);
+        http.addHeader("Accept-Encoding", "gzip");
+    }
+    
+    // Chunked bodies come with no Content-Length - we decode them ourselves
+    const char* headerKeys[] = { "Transfer-Encoding", "Content-Encoding", "ETag", "Last-Modified" };
+    http.collectHeaders(headerKeys, 4);
+    
     int httpCode = http.GET();
-    int newEvents = 0;
-    Serial.printf("[EONET] HTTP %d\n", httpCode);
+    
+    int found = 0;
+    Serial.printf("[%s] HTTP %d\n", src.tag, httpCode);
+    stats.fetches++;
+    stats.lastHttp = httpCode;
     
     feed_watchdog();
     
     if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
-        Serial.printf("[EONET] Received %d bytes\n", payload.length());
+        bool chunked = http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+        String encoding = http.header("Content-Encoding");
+        bool gzip = encoding.equalsIgnoreCase("gzip") || encoding.equalsIgnoreCase("x-gzip");
+        bool compressed = gzip || encoding.equalsIgnoreCase("deflate");
+        Serial.printf("[%s] Content size: %d bytes%s%s\n", src.tag, http.getSize(),
+                      chunked ? " (chunked)" : "", compressed ? " (compressed)" : "");
         
-        if (payload.length() > MAX_JSON_SIZE) {
-            Serial.println("[EONET] ❌ Payload too large");
-            http.end();
-            return 0;
+        // raw -> dechunk -> inflate -> count -> parser
+        Stream& raw = http.getStream();
+        ChunkedStream dechunked(raw);
+        Stream& wire = chunked ? (Stream&)dechunked : (Stream&)raw;
+        InflateStream inflated(wire, gzip);
+        CountingStream body(compressed ? (Stream&)inflated : wire);
+        bool parsedOk = !compressed || inflated.begin();
+        if (!parsedOk) {
+            // Can't decode it - don't drain a body we won't use
+            stats.errors++;
+            tlsClient.stop();
         }
         
-        feed_watchdog();
+        // *** STREAM PARSE - only keep the fields we use ***
+        JsonDocument filter;
+        deserializeJson(filter, src.filter);
         
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        payload = String();
+        // Array feeds are read one item at a time so we can stop once we have enough
+        int count = 0;
+        bool more = parsedOk && (src.arrayKey ? jsonSeekArray(body, src.arrayKey) : true);
+        if (parsedOk && !more) {
+            Serial.printf("[%s] No \"%s\" array in response\n", src.tag, src.arrayKey);
+            parsedOk = false;
+        }
         
-        if (error) {
-            Serial.printf("[EONET] JSON error: %s\n", error.c_str());
-        } else {
-            JsonArray events = doc["events"];
-            Serial.printf("[EONET] Parsed %d events\n", events.size());
+        while (more && count < src.maxItems) {
+            feed_watchdog();
             
-            int count = 0;
-            for (JsonObject event : events) {
-                if (++count > 5) break;
-                feed_watchdog();
-                
-                DisasterEvent evt;
-                memset(&evt, 0, sizeof(evt));
-                
-                const char* id = event["id"] | "unknown";
-                snprintf(evt.id, sizeof(evt.id), "eonet_%s", id);
-                
-                // Get category (fire, storm, volcano, etc.)
-                JsonArray categories = event["categories"];
-                if (categories.size() > 0) {
-                    const char* catId = categories[0]["id"] | "unknown";
-                    strncpy(evt.type, catId, sizeof(evt.type) - 1);
-                } else {
-                    strcpy(evt.type, "event");
+            JsonDocument item;
+            DeserializationError error = deserializeJson(item, body,
+                                                         DeserializationOption::Filter(filter));
+            if (error) {
+                // An empty array lands here too
+                if (count > 0 || !src.arrayKey) {
+                    Serial.printf("[%s] JSON error: %s\n", src.tag, error.c_str());
+                    stats.errors++;
+                    parsedOk = false;
                 }
-                
-                const char* title = event["title"] | "Unknown Event";
-                strncpy(evt.location, title, sizeof(evt.location) - 1);
-                
-                // EONET doesn't have magnitude, use 0
-                evt.magnitude = 0;
-                
-                // Default to orange for active events
-                evt.alertLevel = 1;
-                
-                if (addToQueue(&evt)) newEvents++;
+                more = false;
+                break;
             }
-        }
-    } else {
-        Serial.printf("[EONET] HTTP error: %d\n", httpCode);
-    }
-    
-    http.end();
-    feed_watchdog();
-    
-    Serial.printf("[EONET] %d new events\n", newEvents);
-    return newEvents;
-}
-
-// ==================== FETCH NOAA SPACE WEATHER ====================
-
-int fetchSpaceWeather() {
-    if (!is_memory_safe()) {
-        Serial.println("[SPACE] ❌ Skipping - low memory");
-        return 0;
-    }
-    
-    Serial.println("[SPACE] Fetching space weather...");
-    feed_watchdog();
-    
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
-    http.begin(client, NOAA_SPACE_URL);
-    http.setTimeout(15000);
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    
-    int httpCode = http.GET();
-    int newEvents = 0;
-    Serial.printf("[SPACE] HTTP %d\n", httpCode);
-    
-    feed_watchdog();
-    
-    if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
-        Serial.printf("[SPACE] Received %d bytes\n", payload.length());
-        
-        if (payload.length() == 0 || payload.length() > MAX_JSON_SIZE) {
-            Serial.println("[SPACE] ❌ Invalid payload size");
-            http.end();
-            return 0;
+            count++;
+            
+            found += ingestFeedItem(idx, item.as<JsonObject>());
+            
+            more = src.arrayKey && jsonNextElement(body);
         }
         
-        feed_watchdog();
+        if (compressed && inflated.failed()) parsedOk = false;
         
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        payload = String();
+        uint32_t wireBytes = compressed ? inflated.compressedBytes() : body.count();
+        Serial.printf("[%s] Read %d items (%u bytes, %u on the wire)\n",
+                      src.tag, count, body.count(), wireBytes);
+        stats.changed++;
+        stats.items += count;
+        stats.bytesWire += wireBytes;
+        stats.bytesRead += body.count();
+        if (compressed) stats.gzipped++;
+        stats.lastBodyBytes = http.getSize() > 0 ? http.getSize() : wireBytes;
         
-        if (error) {
-            Serial.printf("[SPACE] JSON error: %s\n", error.c_str());
-        } else {
-            // noaa-scales.json format: {"0": {"DateStamp": "...", "R": {"Scale": 0, ...}, "S": {...}, "G": {...}}}
-            // R = Radio Blackout, S = Solar Radiation, G = Geomagnetic Storm
-            // Scale: 0=none, 1=minor, 2=moderate, 3=strong, 4=severe, 5=extreme
+        // Only trust the validators if we actually used this version
+        if (parsedOk) {
+            storeValidator(validator.etag, sizeof(validator.etag), http.header("ETag"));
+            storeValidator(validator.lastModified, sizeof(validator.lastModified),
+                           http.header("Last-Modified"));
+            result = classifyFetch(idx);
             
-            // Get current day "0" data
-            JsonObject day0 = doc["0"];
-            if (!day0.isNull()) {
-                const char* dateStamp = day0["DateStamp"] | "now";
-                
-                // Check Geomagnetic Storm (G scale)
-                JsonObject gScale = day0["G"];
-                int gLevel = gScale["Scale"] | 0;
-                if (gLevel >= 1) {
-                    DisasterEvent evt;
-                    memset(&evt, 0, sizeof(evt));
-                    snprintf(evt.id, sizeof(evt.id), "noaa_G_%s", dateStamp);
-                    strcpy(evt.type, "GEOMAG");
-                    snprintf(evt.location, sizeof(evt.location), "Geomagnetic Storm G%d", gLevel);
-                    evt.magnitude = gLevel;
-                    evt.alertLevel = (gLevel >= 4) ? 2 : (gLevel >= 2) ? 1 : 0;
-                    if (addToQueue(&evt)) newEvents++;
-                }
-                
-                // Check Solar Radiation (S scale)
-                JsonObject sScale = day0["S"];
-                int sLevel = sScale["Scale"] | 0;
-                if (sLevel >= 1) {
-                    DisasterEvent evt;
-                    memset(&evt, 0, sizeof(evt));
-                    snprintf(evt.id, sizeof(evt.id), "noaa_S_%s", dateStamp);
-                    strcpy(evt.type, "SOLAR");
-                    snprintf(evt.location, sizeof(evt.location), "Solar Radiation S%d", sLevel);
-                    evt.magnitude = sLevel;
-                    evt.alertLevel = (sLevel >= 4) ? 2 : (sLevel >= 2) ? 1 : 0;
-                    if (addToQueue(&evt)) newEvents++;
-                }
-                
-                // Check Radio Blackout (R scale)
-                JsonObject rScale = day0["R"];
-                int rLevel = rScale["Scale"] | 0;
-                if (rLevel >= 1) {
-                    DisasterEvent evt;
-                    memset(&evt, 0, sizeof(evt));
-                    snprintf(evt.id, sizeof(evt.id), "noaa_R_%s", dateStamp);
-                    strcpy(evt.type, "RADIO");
-                    snprintf(evt.location, sizeof(evt.location), "Radio Blackout R%d", rLevel);
-                    evt.magnitude = rLevel;
-                    evt.alertLevel = (rLevel >= 4) ? 2 : (rLevel >= 2) ? 1 : 0;
-                    if (addToQueue(&evt)) newEvents++;
-                }
-                
-                if (newEvents == 0) {
-                    Serial.println("[SPACE] No active space weather events");
-                }
-            } else {
-                Serial.println("[SPACE] No current data in response");
-            }
+            if (src.sinceParam) advanceHighWater(idx, count >= src.maxItems);
+        }
+        
+        // Don't download the rest of a long list
+        if (more) {
+            Serial.printf("[%s] Enough items - closing transfer early\n", src.tag);
+            tlsClient.stop();
         }
+    } else if (httpCode == HTTP_CODE_NO_CONTENT) {
+        // FDSN answers 204 when the time window holds no events
+        Serial.printf("[%s] Nothing new since last poll\n", src.tag);
+        if (src.sinceParam) advanceHighWater(idx, false);   // Ends a run of full pages
+        stats.changed++;
+        result = FEED_UNCHANGED;
+    } else if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        Serial.printf("[%s] Not modified - skipping parse\n", src.tag);
+        stats.notModified++;
+        stats.bytesSaved += stats.lastBodyBytes;
+        result = FEED_UNCHANGED;
     } else {
-        Serial.printf("[SPACE] HTTP error: %d\n", httpCode);
+        Serial.printf("[%s] HTTP error: %d\n", src.tag, httpCode);
+        stats.errors++;
     }
     
     http.end();
     feed_watchdog();
     
-    Serial.printf("[SPACE] %d new alerts\n", newEvents);
-    return newEvents;
+    stats.lastMs = millis() - started;
+    
+    Serial.printf("[%s] %d events (%u ms)\n", src.tag, found, stats.lastMs);
+    return result;
 }
 
-// ==================== FETCH CONFLICTS/WAR (GDELT) ====================
-
-int fetchNWSAlerts() {
-    if (!is_memory_safe()) {
-        Serial.println("[NWS] ❌ Skipping - low memory");
-        return 0;
+void printFeedStats() {
+    Serial.println("[CMD] Feed stats:");
+    for (size_t i = 0; i < FEED_COUNT; i++) {
+        const FeedStats& s = feedStats[i];
+        Serial.printf("  %-6s fetch:%u 200:%u 304:%u err:%u items:%u new:%u http:%d last:%ums\n",
+                      FEEDS[i].tag, s.fetches, s.changed, s.notModified, s.errors,
+                      s.items, s.newEvents, s.lastHttp, s.lastMs);
+        Serial.printf("         wire:%uB json:%uB gzip:%u/%u saved:%uB etag:%s\n",
+                      s.bytesWire, s.bytesRead, s.gzipped, s.changed, s.bytesSaved,
+                      feedValidators[i].etag[0] ? "yes" : "no");
     }
     
-    Serial.println("[NWS] Fetching severe weather...");
-    feed_watchdog();
+    Serial.printf("[CMD] Cross-source quake merges: %u\n", quakesMerged);
+    
+    Serial.println("[CMD] Schedule:");
+    for (size_t i = 0; i < FEED_COUNT; i++) {
+        const FeedSchedule& sch = feedSchedules[i];
+        int32_t dueIn = (int32_t)(sch.nextDueMs - millis()) / 1000;
+        char since[24] = "-";
+        if (feedHighWater[i]) formatIsoTime(feedHighWater[i], since, sizeof(since));
+        Serial.printf("  %-6s next:%lds every:%us fails:%d since:%s%s\n",
+                      FEEDS[i].tag, (long)max(dueIn, (int32_t)0),
+                      (sch.intervalMs ? sch.intervalMs : FEEDS[i].intervalMs) / 1000,
+                      sch.failures, since, sch.burstUntilMs ? " BURST" : "");
+    }
     
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
-    http.begin(client, NWS_ALERTS_URL);
-    http.setTimeout(15000);
-    http.addHeader("User-Agent", "(DisasterAlert/2.4, github.com/disaster-alert)");
-    http.addHeader("Accept", "application/geo+json");
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    Serial.println("[CMD] TLS sessions:");
+    for (const auto& t : tlsSessions) {
+        if (t.host[0] == '\0') continue;
+        Serial.printf("  %-28s full:%u resumed:%u last:%ums\n",
+                      t.host, t.handshakes, t.resumed, t.lastHandshakeMs);
+    }
+}
+
+// ==================== FETCH ALL SOURCES ====================
+
+// Fetch every source that is due (or all of them when forced).
+// Returns the number of sources fetched.
+int fetchAllDisasters(bool force) {
+    int fetched = 0;
+    unsigned long started = millis();
+    
+    for (size_t i = 0; i < FEED_COUNT; i++) {
+        if (!force && !isFeedDue(i)) continue;
+        
+        if (fetched > 0) {
+            delay(1000);
+            feed_watchdog();
+        }
+        scheduleFeed(i, fetchFeed(i));
+        fetched++;
+    }
+    if (fetched == 0) return 0;
     
-    int httpCode = http.GET();
-    int newEvents = 0;
-    Serial.printf("[NWS] HTTP %d\n", httpCode);
+    // Tell loop() the cycle is complete so it can save the moved high-water
+    // marks and log the cycle's new events (loraService() sends on its own clock)
+    postFetchedEvent(NULL, FETCH_CYCLE_DONE);
     
-    feed_watchdog();
+    Serial.printf("[FETCH] %d sources in %lu ms\n", fetched, millis() - started);
+    Serial.printf("[MEM] Free after all: %u bytes\n", ESP.getFreeHeap());
     
-    if (httpCode == HTTP_CODE_OK) {
-        int contentLen = http.getSize();
-        Serial.printf("[NWS] Content size: %d bytes\n", contentLen);
-        
-        // Skip if too large (NWS can return huge responses)
-        if (contentLen > 30000 || contentLen == -1) {
-            Serial.println("[NWS] ⚠️ Response too large, skipping");
-            http.end();
-            return 0;
-        }
+    return fetched;
+}
+
+// ==================== FETCH TASK ====================
+
+#define FETCH_TASK_CORE     0       // PRO core - Arduino loop() runs on core 1
+#define FETCH_TASK_STACK    16384   // mbedTLS handshake + ArduinoJson
+#define FETCH_TASK_PRIORITY 1
+
+TaskHandle_t  fetchTaskHandle     = NULL;
+volatile bool fetchRequested      = false;
+volatile bool fetchFullRequested  = false;   // Also drop ETags and time windows
+
+// Safe to call from loop() - the fetch task picks it up within a second
+void requestFetch(bool full) {
+    if (full) fetchFullRequested = true;
+    fetchRequested = true;
+    if (fetchTaskHandle) xTaskNotifyGive(fetchTaskHandle);
+}
+
+void fetchTask(void* param) {
+    // Watched on its own from the first instruction - a hung TLS read can't
+    // hide behind loop()
+    esp_task_wdt_add(NULL);
+    
+    for (;;) {
+        // Wake on request, or once a second to feed the watchdog and check due times
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        feed_watchdog();
         
-        String payload = http.getString();
+        if (!wifiConnected || !is_memory_safe()) continue;
         
-        if (payload.length() == 0) {
-            Serial.println("[NWS] Empty response");
-            http.end();
-            return 0;
+        // Each source has its own due time - see scheduleFeed()
+        bool force = fetchRequested;
+        fetchRequested = false;
+        if (fetchFullRequested) {
+            fetchFullRequested = false;
+            resetFeedCaches();
         }
         
-        feed_watchdog();
-        
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
-        payload = String();  // Free memory
-        
-        if (error) {
-            Serial.printf("[NWS] JSON error: %s\n", error.c_str());
-        } else {
-            JsonArray features = doc["features"];
-            int alertCount = features.size();
-            Serial.printf("[NWS] Found %d extreme alerts\n", alertCount);
-            
-            if (alertCount == 0) {
-                Serial.println("[NWS] No extreme weather alerts active");
-            }
-            
-            int count = 0;
-            for (JsonObject feature : features) {
-                if (++count > 3) break;  // Limit to 3 alerts
-                feed_watchdog();
-                
-                DisasterEvent evt;
-                memset(&evt, 0, sizeof(evt));
-                
-                JsonObject props = feature["properties"];
-                
-                // Get ID (use first 20 chars)
-                const char* id = props["id"] | "";
-                snprintf(evt.id, sizeof(evt.id), "nws_%.16s", id + (strlen(id) > 16 ? strlen(id) - 16 : 0));
-                
-                // Get event type
-                const char* eventName = props["event"] | "Alert";
-                
-                // Map to our types
-                if (strstr(eventName, "Tornado") != NULL) {
-                    strcpy(evt.type, "TORNADO");
-                    evt.alertLevel = 2;
-                } else if (strstr(eventName, "Hurricane") != NULL) {
-                    strcpy(evt.type, "TC");
-                    evt.alertLevel = 2;
-                } else if (strstr(eventName, "Tsunami") != NULL) {
-                    strcpy(evt.type, "TSUNAMI");
-                    evt.alertLevel = 2;
-                } else if (strstr(eventName, "Flash Flood") != NULL) {
-                    strcpy(evt.type, "FL");
-                    evt.alertLevel = 2;
-                } else if (strstr(eventName, "Fire") != NULL) {
-                    strcpy(evt.type, "WF");
-                    evt.alertLevel = 2;
-                } else {
-                    strcpy(evt.type, "EXTREME");
-                    evt.alertLevel = 2;
-                }
-                
-                // Get short headline
-                const char* headline = props["headline"] | eventName;
-                strncpy(evt.location, headline, sizeof(evt.location) - 1);
-                // Truncate at 60 chars for display
-                if (strlen(evt.location) > 60) {
-                    evt.location[57] = '.';
-                    evt.location[58] = '.';
-                    evt.location[59] = '.';
-                    evt.location[60] = '\0';
-                }
-                
-                evt.magnitude = 0;
-                
-                if (addToQueue(&evt)) newEvents++;
-            }
+        if (force) Serial.println("[FETCH] Requested check of all sources...");
+        if (fetchAllDisasters(force) > 0) {
+            Serial.printf("[FETCH] Task stack free: %u bytes\n", uxTaskGetStackHighWaterMark(NULL));
         }
-    } else {
-        Serial.printf("[NWS] HTTP error: %d\n", httpCode);
     }
-    
-    http.end();
-    feed_watchdog();
-    
-    Serial.printf("[NWS] %d new alerts\n", newEvents);
-    return newEvents;
 }
 
-// ==================== FETCH ALL SOURCES ====================
+void startFetchTask() {
+    xTaskCreatePinnedToCore(fetchTask, "fetch", FETCH_TASK_STACK, NULL,
+                            FETCH_TASK_PRIORITY, &fetchTaskHandle, FETCH_TASK_CORE);
+    Serial.printf("[FETCH] Task started on core %d\n", FETCH_TASK_CORE);
+}
 
-int fetchAllDisasters() {
-    // Don't clear LoRa queue - we accumulate for hourly send
-    
-    int total = 0;
-    
-    // Earthquakes (US)
-    total += fetchUSGS();
-    delay(1000);
-    feed_watchdog();
-    
-    // Earthquakes (Europe/World)
-    total += fetchEMSC();
-    delay(1000);
-    feed_watchdog();
-    
-    // NASA events (fires, storms, volcanoes)
-    total += fetchEONET();
-    delay(1000);
-    feed_watchdog();
-    
-    // Space weather (solar flares, geomagnetic storms)
-    total += fetchSpaceWeather();
-    delay(1000);
-    feed_watchdog();
-    
-    // NWS Severe Weather Alerts (Tornadoes, Hurricanes, etc)
-    total += fetchNWSAlerts();
-    
-    // Queue for hourly LoRa send (don't send immediately)
-    flushLoraQueue();
-    
-    Serial.printf("[FETCH] Total: %d new events\n", total);
-    Serial.printf("[MEM] Free after all: %u bytes\n", ESP.getFreeHeap());
-    
-    return total;
+// Called from loop() - moves fetched events into the display and LoRa queues
+void drainFetchedEvents() {
+    static int cycleNew = 0;
+    
+    FetchedEvent fe;
+    while (fetchedEvents.pop(fe)) {
+        if (fe.source == FETCH_CYCLE_DONE) {
+            state_dirty = true;   // High-water marks may have moved
+            Serial.printf("[FETCH] %d new events this cycle\n", cycleNew);
+            cycleNew = 0;
+            continue;
+        }
+        
+        if (addToQueue(&fe.evt)) {
+            historyAppend(&fe.evt);
+            feedStats[fe.source].newEvents++;
+            cycleNew++;
+        }
+    }
 }
 
 // ==================== MESH CHAT (PROTECTED) ====================
@@ -1471,17 +3990,86 @@ void monitor_mesh_chat() {
         
         isCommand = true;
         
-        // Check for specific commands
-        if (msgLower.indexOf("status") >= 0 || msgLower.indexOf("stat") >= 0) {
+        // Check for specific commands ("hist" first - "history eq" would read as quake)
+        if (msgLower.indexOf("hist") >= 0) {
+            // e844 hist [type] [m<mag>] [<n>h|<n>d] - newest archived events
+            HistoryQuery q = {};
+            char unknown[16] = "";
+            char args[UART_MSG_MAX_LEN + 1];
+            int at = msgLower.indexOf(' ', msgLower.indexOf("hist"));
+            strncpy(args, at >= 0 ? msgLower.c_str() + at : "", sizeof(args) - 1);
+            args[sizeof(args) - 1] = '\0';
+            
+            bool needClock = false;
+            for (char* tok = strtok(args, " "); tok; tok = strtok(NULL, " ")) {
+                float v;
+                char unit;
+                if (tok[0] == 'm' && sscanf(tok + 1, "%f", &v) == 1) {
+                    q.minMag = v;
+                } else if (sscanf(tok, "%f%c", &v, &unit) == 2 && (unit == 'h' || unit == 'd')) {
+                    time_t now = time(NULL);
+                    needClock = now < (time_t)HWM_SANE_MIN;
+                    q.from = now - (uint32_t)(v * (unit == 'd' ? 86400 : 3600));
+                } else if (findEventType(tok, &q.type)) {
+                    q.byType = true;            // "quake", "eq", "earthquakes"...
+                } else {
+                    strncpy(unknown, tok, sizeof(unknown) - 1);
+                }
+            }
+            
+            if (unknown[0]) {
+                char reply[64];
+                snprintf(reply, sizeof(reply), "❓ Unknown type '%s' - e844 codes lists them", unknown);
+                sendToHeltec(reply);
+            } else if (needClock) {
+                sendToHeltec("⏰ Clock not synced yet - try without a time window");
+            } else {
+                HistoryRecord found[3];
+                int n = historyQuery(q, found, 3);
+                if (n == 0) sendToHeltec("📜 No matching events in history");
+                for (int i = 0; i < n; i++) {
+                    char when[24] = "?";
+                    if (historyTime(found[i])) formatIsoTime(historyTime(found[i]), when, sizeof(when));
+                    char reply[120];
+                    if (found[i].magnitude > 0) {
+                        snprintf(reply, sizeof(reply), "📜 %.10s %s M%.1f %s", when,
+                                 getEventTypeName(parseEventType(found[i].type)), found[i].magnitude, found[i].location);
+                    } else {
+                        snprintf(reply, sizeof(reply), "📜 %.10s %s %s", when,
+                                 getEventTypeName(parseEventType(found[i].type)), found[i].location);
+                    }
+                    sendToHeltec(reply);
+                    delay(500);
+                }
+            }
+            
+        } else if (msgLower.indexOf("status") >= 0 || msgLower.indexOf("stat") >= 0) {
             // Status command
             char reply[120];
             snprintf(reply, sizeof(reply), 
                 "📊 STATUS: WiFi:%s | Mem:%uKB | Queue:%d | Seen:%d events",
                 wifiConnected ? "OK" : "DOWN",
                 ESP.getFreeHeap() / 1024,
-                loraQueueCount,
-                seenCount);
+                loraPending(),
+                seen.count);
             sendToHeltec(reply);
+            delay(LORA_TX_GAP_MS);
+            
+            // Airtime, then per level (red/orange/green): sent, avg wait, dropped
+            char air[160];
+            uint32_t avg[3];
+            for (int l = 0; l < 3; l++) {
+                avg[l] = loraStats.sent[l] ? loraStats.waitSumS[l] / loraStats.sent[l] : 0;
+            }
+            loraRefill();
+            snprintf(air, sizeof(air),
+                "📡 Air:%lus Budget:%ld%% | R %u/%lus/%u | O %u/%lus/%u | G %u/%lus/%u",
+                (unsigned long)loraStats.airtimeMs / 1000,
+                max(0L, loraTokensMs) * 100 / LORA_BUCKET_MS,
+                loraStats.sent[2], (unsigned long)avg[2], loraStats.dropped[2],
+                loraStats.sent[1], (unsigned long)avg[1], loraStats.dropped[1],
+                loraStats.sent[0], (unsigned long)avg[0], loraStats.dropped[0]);
+            sendToHeltec(air);
             
         } else if (msgLower.indexOf("quake") >= 0 || msgLower.indexOf("eq") >= 0) {
             // Last earthquake info
@@ -1492,6 +4080,10 @@ void monitor_mesh_chat() {
                 sendToHeltec(reply);
             }
             
+        } else if (msgLower.indexOf("codes") >= 0 || msgLower.indexOf("legend") >= 0) {
+            // Type codes used in packed alert frames
+            sendLoraCodes();
+            
         } else if (msgLower.indexOf("help") >= 0 || msgLower.indexOf("?") >= 0) {
             // Help command
             delay(300);
@@ -1506,6 +4098,10 @@ void monitor_mesh_chat() {
             sendToHeltec("• e844 ping - Test connection");
             delay(500);
             sendToHeltec("• e844 send - Force send alerts");
+            delay(500);
+            sendToHeltec("• e844 hist [type] [m5] [24h] - Past events");
+            delay(500);
+            sendToHeltec("• e844 codes - Alert frame codes");
             
         } else if (msgLower.indexOf("weather") >= 0 || msgLower.indexOf("solar") >= 0 || 
                    msgLower.indexOf("space") >= 0) {
@@ -1521,7 +4117,7 @@ void monitor_mesh_chat() {
             
         } else if (msgLower.indexOf("send") >= 0 || msgLower.indexOf("flush") >= 0) {
             // Force send LoRa queue
-            if (loraQueueCount > 0) {
+            if (loraPending() > 0) {
                 sendToHeltec("📡 Sending queued alerts NOW...");
                 delay(500);
                 sendLoraQueueNow();
@@ -1547,6 +4143,7 @@ void monitor_mesh_chat() {
         
         // Shorter delay with watchdog feeding
         for (int i = 0; i < 50; i++) {
+            displayService();
             delay(100);
             feed_watchdog();
         }
@@ -1554,6 +4151,7 @@ void monitor_mesh_chat() {
         // Brief display for commands
         display_mesh_chat(incomingChat.c_str());
         for (int i = 0; i < 20; i++) {
+            displayService();
             delay(100);
             feed_watchdog();
         }
@@ -1579,6 +4177,7 @@ void setup() {
     tft.init();
     tft.setRotation(1);
     tft.fillScreen(TFT_BLACK);
+    initFrameBuffer();   // Before WiFi/TLS fragment the heap
     
     // Backlight with PWM
     ledcSetup(0, 5000, 8);
@@ -1587,18 +4186,24 @@ void setup() {
     
     Serial.println("\n=================================");
     Serial.println("  E844 Disaster Alert v2.4");
-    Serial.println("  + Chat Bot + Hourly LoRa");
+    Serial.println("  + Chat Bot + Paced LoRa");
     Serial.println("=================================\n");
     
-    // *** INIT WATCHDOG ***
+    // *** INIT WATCHDOG *** - before any task it has to watch exists
     init_watchdog();
     
+    // *** FETCH TASK (core 0) - idles until WiFi is up ***
+    startFetchTask();
+    
     // Init UART for Meshtastic
     Serial1.begin(MESH_BAUD, SERIAL_8N1, MESH_RX_PIN, MESH_TX_PIN);
     Serial.printf("[MESH] TX:%d RX:%d %dbaud\n", MESH_TX_PIN, MESH_RX_PIN, MESH_BAUD);
     
-    eeprom_load();
+    seenLogLoad();
+    state_load();
+    historyLoad();
     showStartup();
+    displayFinish();
     delay(2000);
     
     feed_watchdog();
@@ -1619,11 +4224,13 @@ void setup() {
         feed_watchdog();
         Serial.printf("[WIFI] Status:%d\n", WiFi.status());
         showConnecting(dots++);
+        displayFinish();
         delay(500);
         
         if (millis() - start > WIFI_TIMEOUT_MS) {
             Serial.println("[WIFI] Timeout!");
             showError("WIFI FAIL");
+            displayFinish();
             delay(5000);
             break;
         }
@@ -1635,15 +4242,16 @@ void setup() {
         wifiConnected = true;
         Serial.print("[WIFI] IP: ");
         Serial.println(WiFi.localIP());
+        
+        // UTC clock for seen-ID expiry - SNTP keeps it synced in the background
+        configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+        
         showConnected();
+        displayFinish();
         delay(1500);
         
         showFetching();
-        delay(500);
-        
-        int n = fetchAllDisasters();
-        Serial.printf("[FETCH] %d new events\n", n);
-        lastFetchTime = millis();
+        requestFetch(false);
     }
     
     Serial.println("[MAIN] System Ready");
@@ -1655,9 +4263,11 @@ void loop() {
     // *** FEED WATCHDOG EVERY LOOP ***
     feed_watchdog();
     
-    // Check buttons
+    // Check buttons - and keep display strips flowing between them
     for (int i = 0; i < 20; i++) {
         check_buttons();
+        displayService();
+        marqueeService();
         delay(1);
     }
     
@@ -1669,10 +4279,9 @@ void loop() {
         char cmd = Serial.read();
         if (cmd == 'C' || cmd == 'c') {
             Serial.println("[CMD] Clear");
-            eeprom_clear();
+            state_clear();
             if (wifiConnected) {
-                fetchAllDisasters();
-                lastFetchTime = millis();
+                requestFetch(true);  // Force full downloads, not 304s
             }
         }
         if (cmd == 'T' || cmd == 't') {
@@ -1687,8 +4296,20 @@ void loop() {
             Serial.printf("[CMD] Memory: %u free, %u min\n", 
                           ESP.getFreeHeap(), ESP.getMinFreeHeap());
         }
+        if (cmd == 'D' || cmd == 'd') {
+            printDisplayStats();
+        }
+        if (cmd == 'W' || cmd == 'w') {
+            showWorldMap(true);
+            idleShowsMap = true;
+            idleSwitchedAt = lastDisplayChange = millis();
+        }
         if (cmd == 'E' || cmd == 'e') {
-            Serial.printf("[CMD] EEPROM writes: %u\n", total_eeprom_writes);
+            printStateStats();
+            printSeenLogStats();
+        }
+        if (cmd == 'F' || cmd == 'f') {
+            printFeedStats();
         }
         if (cmd == 'U' || cmd == 'u') {
             Serial.println("[CMD] UART reset");
@@ -1696,18 +4317,21 @@ void loop() {
             flush_uart_garbage();
         }
         if (cmd == 'Q' || cmd == 'q') {
-            Serial.printf("[CMD] LoRa queue: %d messages pending\n", loraQueueCount);
-            unsigned long nextSend = (lastLoraSendTime + LORA_SEND_INTERVAL_MS - millis()) / 60000;
-            Serial.printf("[CMD] Next hourly send in: %lu minutes\n", nextSend);
+            Serial.printf("[CMD] Display queue: %d waiting, dropped green:%u orange:%u red:%u\n",
+                          queueCount, queueDropped[0], queueDropped[1], queueDropped[2]);
+            printLoraStats();
         }
         if (cmd == 'H' || cmd == 'h' || cmd == '?') {
             Serial.println("\n=== COMMANDS ===");
-            Serial.println("C = Clear EEPROM & refetch");
+            Serial.println("C = Clear saved state & refetch");
             Serial.println("T = Test LoRa TX");
             Serial.println("L = Force send LoRa queue NOW");
-            Serial.println("Q = Show LoRa queue status");
+            Serial.println("Q = Display & LoRa queue status");
             Serial.println("M = Memory status");
-            Serial.println("E = EEPROM write count");
+            Serial.println("D = Display SPI stats");
+            Serial.println("W = Show world map now");
+            Serial.println("E = State & seen log write stats");
+            Serial.println("F = Feed stats (304s, bytes saved, TLS)");
             Serial.println("U = Reset UART health");
             Serial.println("H = This help\n");
         }
@@ -1716,42 +4340,55 @@ void loop() {
     // Monitor mesh chat
     monitor_mesh_chat();
     
-    // Check if time to send hourly LoRa digest
-    checkLoraHourlySend();
+    // Next LoRa packet, if the airtime budget allows
+    loraService();
     
     // Monitor WiFi
     if (wifiConnected && WiFi.status() != WL_CONNECTED) {
         wifiConnected = false;
         Serial.println("[WIFI] Lost!");
         showError("WIFI LOST");
+        displayFinish();
         delay(3000);
     }
     
-    // Periodic fetch (only if memory is safe)
-    if (wifiConnected && is_memory_safe() && 
-        (millis() - lastFetchTime >= FETCH_INTERVAL_MS)) {
-        Serial.println("[FETCH] Periodic check...");
-        showFetching();
-        delay(500);
-        fetchAllDisasters();
-        lastFetchTime = millis();
+    // Pick up whatever the fetch task has found (fetching itself runs on core 0)
+    drainFetchedEvents();
+    
+    // Snapshot queues + high-water marks once changes have settled
+    if (state_dirty && millis() - last_state_save_time >= STATE_MIN_SAVE_INTERVAL) {
+        state_save();
     }
     
     // Update display
     unsigned long now = millis();
     if (queueCount > 0) {
-        if (!showingAlert || (now - lastDisplayChange >= DISPLAY_DURATION_MS)) {
-            if (getFromQueue(&currentEvent)) {
-                showAlert(&currentEvent);
+        bool preempt = queuePreempts(showingAlert, currentEvent);
+        if (!showingAlert || preempt || (now - lastDisplayChange >= DISPLAY_DURATION_MS)) {
+            if (preempt && showingAlert) Serial.println("[DISPLAY] 🔴 Red alert preempts current screen");
+            if (getFromQueue(&currentEvent, &currentLayout)) {
+                showAlert(&currentEvent, &currentLayout);
                 showingAlert = true;
                 lastDisplayChange = now;
                 Serial.printf("[DISPLAY] M%.1f %s\n", 
-                              currentEvent.magnitude, currentEvent.location);
+                              eventMagnitude(currentEvent), eventLocation(currentEvent));
             }
         }
     } else {
-        if (showingAlert || (now - lastDisplayChange >= 5000)) {
-            showNoAlerts();
+        // Switching repaints the whole screen, so it's slow; in between the
+        // status screen refreshes its readout (a few dirty tiles) and the
+        // map redraws only if its markers changed
+        bool switchScreen = showingAlert || (now - idleSwitchedAt >= IDLE_SWITCH_MS);
+        if (switchScreen || (now - lastDisplayChange >= IDLE_REFRESH_MS)) {
+            if (switchScreen) {
+                idleShowsMap = !showingAlert && !idleShowsMap;   // Status first after an alert
+                idleSwitchedAt = now;
+            }
+            if (idleShowsMap) {
+                showWorldMap(switchScreen);
+            } else {
+                showNoAlerts();
+            }
             showingAlert = false;
             lastDisplayChange = now;
         }
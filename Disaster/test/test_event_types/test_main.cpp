@@ -0,0 +1,194 @@
+// Event type table: every code maps where the old strcmp() chain sent it, and
+// a benchmark of the two. Run with: pio test -e native -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "event_types.h"
+
+// ----- The old implementation, as it was -----
+
+static const char* oldEventTypeName(const char* code) {
+    if (!code || strlen(code) == 0) return "ALERT";
+
+    // Earthquakes & Geological
+    if (strcmp(code, "EQ") == 0) return "QUAKE";
+    if (strcmp(code, "VO") == 0) return "VOLCANO";
+    if (strcmp(code, "volcano") == 0) return "VOLCANO";
+    if (strcmp(code, "landslide") == 0) return "SLIDE";
+
+    // Severe Weather (NWS)
+    if (strcmp(code, "TORNADO") == 0) return "TORNADO";
+    if (strcmp(code, "TSUNAMI") == 0) return "TSUNAMI";
+    if (strcmp(code, "TC") == 0) return "CYCLONE";
+    if (strcmp(code, "FL") == 0) return "FLOOD";
+    if (strcmp(code, "flood") == 0) return "FLOOD";
+    if (strcmp(code, "DR") == 0) return "DROUGHT";
+    if (strcmp(code, "STORM") == 0) return "STORM";
+    if (strcmp(code, "storm") == 0) return "STORM";
+    if (strcmp(code, "severeStorm") == 0) return "STORM";
+    if (strcmp(code, "SNOW") == 0) return "BLIZZARD";
+    if (strcmp(code, "snow") == 0) return "SNOW";
+    if (strcmp(code, "iceberg") == 0) return "ICEBERG";
+    if (strcmp(code, "WEATHER") == 0) return "WEATHER";
+    if (strcmp(code, "EXTREME") == 0) return "EXTREME";
+
+    // Fire
+    if (strcmp(code, "WF") == 0) return "WILDFIRE";
+    if (strcmp(code, "fire") == 0) return "FIRE";
+    if (strcmp(code, "wildfire") == 0) return "FIRE";
+
+    // Space Weather
+    if (strcmp(code, "SOLAR") == 0) return "SOLAR";
+    if (strcmp(code, "GEOMAG") == 0) return "GEOMAG";
+    if (strcmp(code, "RADIO") == 0) return "RADIO";
+    if (strcmp(code, "FLARE") == 0) return "FLARE";
+    if (strcmp(code, "CME") == 0) return "CME";
+
+    // Military / Conflict (kept for future use)
+    if (strcmp(code, "WAR") == 0) return "WAR";
+    if (strcmp(code, "DEFCON") == 0) return "DEFCON";
+    if (strcmp(code, "NUKE") == 0) return "NUKE";
+    if (strcmp(code, "MILITARY") == 0) return "MILITARY";
+    if (strcmp(code, "CONFLICT") == 0) return "CONFLICT";
+    if (strcmp(code, "TERROR") == 0) return "TERROR";
+    if (strcmp(code, "EMERGENCY") == 0) return "EMERGENCY";
+
+    // Health
+    if (strcmp(code, "EPIDEMIC") == 0) return "EPIDEMIC";
+    if (strcmp(code, "PANDEMIC") == 0) return "PANDEMIC";
+    if (strcmp(code, "OUTBREAK") == 0) return "OUTBREAK";
+
+    // Other
+    if (strcmp(code, "CYBER") == 0) return "CYBER";
+    if (strcmp(code, "PLANE") == 0) return "PLANE";
+    if (strcmp(code, "SHIP") == 0) return "SHIP";
+    if (strcmp(code, "TRAIN") == 0) return "TRAIN";
+
+    return "ALERT";
+}
+
+// What the feeds send, roughly in proportion: mostly quakes, some weather,
+// the odd EONET category and a few codes neither version knows
+static const char* const FEED_MIX[] = {
+    "EQ", "EQ", "EQ", "EQ", "EQ", "EQ", "TC", "FL", "VO", "DR",
+    "WF", "TORNADO", "STORM", "WEATHER", "EXTREME", "GEOMAG",
+    "wildfires", "severeStorms", "volcanoes", "seaLakeIce",
+    "Hail", "Fog", "",
+};
+#define FEED_MIX_COUNT  ((int)(sizeof(FEED_MIX) / sizeof(FEED_MIX[0])))
+
+void setUp() {}
+void tearDown() {}
+
+// ----- Correctness -----
+
+void test_every_old_code_keeps_its_name() {
+    // Every string the old chain recognised, plus what it fell through on
+    static const char* const OLD_CODES[] = {
+        "EQ", "VO", "volcano", "landslide", "TORNADO", "TSUNAMI", "TC", "FL",
+        "flood", "DR", "STORM", "storm", "severeStorm", "SNOW", "snow",
+        "iceberg", "WEATHER", "EXTREME", "WF", "fire", "wildfire", "SOLAR",
+        "GEOMAG", "RADIO", "FLARE", "CME", "WAR", "DEFCON", "NUKE", "MILITARY",
+        "CONFLICT", "TERROR", "EMERGENCY", "EPIDEMIC", "PANDEMIC", "OUTBREAK",
+        "CYBER", "PLANE", "SHIP", "TRAIN", "", "eq", "Hail", "EQX",
+    };
+    for (const char* code : OLD_CODES) {
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(oldEventTypeName(code),
+                                         getEventTypeName(parseEventType(code)), code);
+    }
+    TEST_ASSERT_EQUAL_STRING("ALERT", getEventTypeName(parseEventType(NULL)));
+}
+
+void test_every_listed_code_parses_to_its_type() {
+    for (int i = 0; i < EVENT_CODE_COUNT; i++) {
+        TEST_ASSERT_TRUE_MESSAGE(parseEventType(EVENT_CODES[i].code) == EVENT_CODES[i].type,
+                                 EVENT_CODES[i].code);
+    }
+}
+
+void test_mesh_codes_are_unique() {
+    const int n = sizeof(EVENT_TYPE_INFO) / sizeof(EVENT_TYPE_INFO[0]);
+    for (int i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_INT(2, (int)strlen(EVENT_TYPE_INFO[i].mesh));
+        for (int j = i + 1; j < n; j++) {
+            TEST_ASSERT_TRUE_MESSAGE(strcmp(EVENT_TYPE_INFO[i].mesh, EVENT_TYPE_INFO[j].mesh) != 0,
+                                     EVENT_TYPE_INFO[i].mesh);
+        }
+    }
+}
+
+void test_typed_words_find_their_type() {
+    struct Typed { const char* word; EventType type; };
+    static const Typed TYPED[] = {
+        { "quake", EventType::Quake },      { "QUAKE", EventType::Quake },
+        { "eq", EventType::Quake },         { "earthquake", EventType::Quake },
+        { "earthquakes", EventType::Quake }, { "quakes", EventType::Quake },
+        { "snow", EventType::Snow },        { "blizzard", EventType::Blizzard },
+        { "fire", EventType::Fire },        { "wildfire", EventType::Wildfire },
+        { "floods", EventType::Flood },     { "typhoon", EventType::Cyclone },
+        { "tc", EventType::Cyclone },       { "volcanoes", EventType::Volcano },
+    };
+    for (const Typed& t : TYPED) {
+        EventType found = EventType::Alert;
+        TEST_ASSERT_TRUE_MESSAGE(findEventType(t.word, &found), t.word);
+        TEST_ASSERT_TRUE_MESSAGE(found == t.type, t.word);
+    }
+
+    EventType found;
+    TEST_ASSERT_FALSE(findEventType("hail", &found));
+    TEST_ASSERT_FALSE(findEventType("s", &found));
+    TEST_ASSERT_FALSE(findEventType("", &found));
+    TEST_ASSERT_FALSE(findEventType(NULL, &found));
+}
+
+// ----- Benchmark -----
+
+template <typename F>
+static double nsPerLookup(int rounds, F lookup) {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t sum = 0;
+    for (int r = 0; r < rounds; r++) sum += lookup(FEED_MIX[r % FEED_MIX_COUNT]);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(sum > 0);      // Keeps the loop from being optimized away
+    return (double)ns / rounds;
+}
+
+void test_lookup_cost() {
+    const int rounds = 2000000;
+
+    // Old: the type stayed a string and every draw ran the chain again
+    double oldNs = nsPerLookup(rounds, [](const char* code) {
+        return (uint32_t)(uint8_t)oldEventTypeName(code)[0];
+    });
+    // New: the chain's job at parse time - one hash, one compare
+    double parseNs = nsPerLookup(rounds, [](const char* code) {
+        return (uint32_t)parseEventType(code) + 1;
+    });
+    // New: what every draw after that costs
+    static EventType parsed[FEED_MIX_COUNT];
+    for (int i = 0; i < FEED_MIX_COUNT; i++) parsed[i] = parseEventType(FEED_MIX[i]);
+    int r = 0;
+    double nameNs = nsPerLookup(rounds, [&r](const char*) {
+        return (uint32_t)(uint8_t)getEventTypeName(parsed[r++ % FEED_MIX_COUNT])[0];
+    });
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "ns per lookup: strcmp chain %.1f, hash table parse %.1f, name of parsed type %.1f",
+             oldNs, parseNs, nameNs);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_TRUE(parseNs < oldNs);
+    TEST_ASSERT_TRUE(nameNs < parseNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_old_code_keeps_its_name);
+    RUN_TEST(test_every_listed_code_parses_to_its_type);
+    RUN_TEST(test_mesh_codes_are_unique);
+    RUN_TEST(test_typed_words_find_their_type);
+    RUN_TEST(test_lookup_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+// Packed LoRa frames: a recorded burst of alerts goes out through the same
+// 24-deep queue the device uses, packed, and is compared with sending one
+// readable alert per frame. Run with: pio test -e native -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "spsc_ring.h"
+#include "lora_frame.h"
+
+#define QUEUE_SIZE       24     // As LORA_QUEUE_SIZE in main.cpp
+#define TX_OVERHEAD_MS   300    // As LORA_TX_OVERHEAD_MS
+#define MS_PER_BYTE      8      // As LORA_MS_PER_BYTE
+
+struct Recorded {
+    EventType   type;
+    int16_t     magnitude10;
+    const char* location;
+};
+
+// A busy hour: USGS and EMSC quakes, GDACS and EONET events
+static const Recorded BURST[] = {
+    { EventType::Quake,    61, "45 km SSW of Tobelo, Indonesia" },
+    { EventType::Quake,    55, "SOUTHERN SUMATRA, INDONESIA" },
+    { EventType::Quake,    48, "Kermadec Islands region" },
+    { EventType::Quake,    52, "South Sandwich Islands region" },
+    { EventType::Quake,    47, "12 km E of Hualien City, Taiwan" },
+    { EventType::Quake,    50, "PERU-ECUADOR BORDER REGION" },
+    { EventType::Wildfire,  0, "Central California, United States" },
+    { EventType::Volcano,   0, "Kamchatka Peninsula, Russia" },
+    { EventType::Flood,     0, "Northern Philippines" },
+    { EventType::Tsunami,   0, "Tonga" },
+    { EventType::Cyclone,   0, "Western Pacific Ocean" },
+    { EventType::Quake,    63, "Off the coast of Central Chile" },
+    { EventType::Quake,    46, "Fiji Islands region" },
+    { EventType::Quake,    58, "Near east coast of Honshu, Japan" },
+    { EventType::Wildfire,  0, "Lake County, California" },
+    { EventType::Quake,    49, "Mid-Atlantic Ridge" },
+    { EventType::Flood,     0, "Eastern Indonesia" },
+    { EventType::Quake,    53, "Papua New Guinea" },
+    { EventType::Quake,    45, "Crete, Greece" },
+    { EventType::Volcano,   0, "Mount Etna, Italy" },
+};
+#define BURST_COUNT  ((int)(sizeof(BURST) / sizeof(BURST[0])))
+
+// Stands in for the location arena: handle = BURST index + 1
+static LoraMessage toMessage(int i) {
+    LoraMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = BURST[i].type;
+    m.magnitude10 = BURST[i].magnitude10;
+    m.location = (uint8_t)(i + 1);
+    return m;
+}
+
+static const char* locate(const LoraMessage& m) {
+    return m.location ? BURST[m.location - 1].location : "";
+}
+
+struct Totals {
+    int    frames;
+    size_t bytes;
+    long   airtimeMs;
+};
+
+static void addFrame(Totals& t, const char* frame) {
+    size_t len = strlen(frame);
+    TEST_ASSERT_LESS_OR_EQUAL(LORA_PAYLOAD_MAX, len);
+    t.frames++;
+    t.bytes += len;
+    t.airtimeMs += TX_OVERHEAD_MS + (long)len * MS_PER_BYTE;
+}
+
+// Before: every alert its own readable frame
+static Totals sendOnePerFrame() {
+    Totals t = { 0, 0, 0 };
+    char frame[LORA_PAYLOAD_MAX + 1];
+    for (int i = 0; i < BURST_COUNT; i++) {
+        LoraMessage m = toMessage(i);
+        formatLoraReadable(m, locate(m), frame, sizeof(frame));
+        addFrame(t, frame);
+    }
+    return t;
+}
+
+// After: queue what fits, send packed frames until it's empty, repeat
+static Totals sendPacked() {
+    Totals t = { 0, 0, 0 };
+    SpscRing<LoraMessage, QUEUE_SIZE> queue;
+    char frame[LORA_PAYLOAD_MAX + 1];
+    int queued = 0, sent = 0;
+    while (sent < BURST_COUNT) {
+        while (queued < BURST_COUNT && queue.push(toMessage(queued))) queued++;
+        int count = packLoraFrame(queue, locate, frame, sizeof(frame));
+        TEST_ASSERT_GREATER_THAN(0, count);
+        addFrame(t, frame);
+        for (int i = 0; i < count; i++) queue.drop();
+        sent += count;
+    }
+    TEST_ASSERT_EQUAL_INT(BURST_COUNT, sent);
+    TEST_ASSERT_TRUE(queue.empty());
+    return t;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_single_alert_goes_out_readable() {
+    SpscRing<LoraMessage, QUEUE_SIZE> queue;
+    queue.push(toMessage(0));
+    char frame[LORA_PAYLOAD_MAX + 1];
+    TEST_ASSERT_EQUAL_INT(1, packLoraFrame(queue, locate, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_STRING("QUAKE M6.1 45 km SSW of Tobelo, Indonesia", frame);
+}
+
+void test_packed_frame_layout() {
+    SpscRing<LoraMessage, QUEUE_SIZE> queue;
+    queue.push(toMessage(0));
+    queue.push(toMessage(6));
+    queue.push(toMessage(9));
+    char frame[LORA_PAYLOAD_MAX + 1];
+    TEST_ASSERT_EQUAL_INT(3, packLoraFrame(queue, locate, frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_STRING("⚠3 EQ61 Tobelo,ID;WF C CA,US;TS TO", frame);
+    TEST_ASSERT_EQUAL_INT(3, (int)queue.size());     // Building a frame takes nothing off
+}
+
+void test_region_dictionary() {
+    char region[LORA_REGION_MAX + 1];
+    compactRegion("Off the coast of Central Chile", region, sizeof(region));
+    TEST_ASSERT_EQUAL_STRING("off C CL", region);
+    compactRegion("Kamchatka Peninsula, Russia", region, sizeof(region));
+    TEST_ASSERT_EQUAL_STRING("Kam Pen,RU", region);
+    compactRegion("SOUTHERN SUMATRA, INDONESIA", region, sizeof(region));
+    TEST_ASSERT_EQUAL_STRING("S SUMATRA,ID", region);
+}
+
+void test_burst_frames_and_bytes() {
+    Totals before = sendOnePerFrame();
+    Totals after = sendPacked();
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "%d alerts - one per frame: %d frames, %u bytes, %ldms air; packed: %d frames, %u bytes, %ldms air",
+             BURST_COUNT, before.frames, (unsigned)before.bytes, before.airtimeMs,
+             after.frames, (unsigned)after.bytes, after.airtimeMs);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_EQUAL_INT(BURST_COUNT, before.frames);
+    TEST_ASSERT_EQUAL_INT(2, after.frames);
+    TEST_ASSERT_LESS_THAN(before.bytes / 2, after.bytes);
+    TEST_ASSERT_LESS_THAN(before.airtimeMs / 3, after.airtimeMs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_alert_goes_out_readable);
+    RUN_TEST(test_packed_frame_layout);
+    RUN_TEST(test_region_dictionary);
+    RUN_TEST(test_burst_frames_and_bytes);
+    return UNITY_END();
+}
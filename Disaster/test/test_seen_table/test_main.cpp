@@ -0,0 +1,209 @@
+// Seen-ID table: correctness, and a benchmark against the 20 x 24-char array
+// with linear strcmp() it replaced. Run with: pio test -e native -v
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <set>
+#include "seen_table.h"
+
+#define LIVE_IDS     300        // "Several hundred" - what a busy day keeps live
+#define TABLE_SLOTS  384        // As SEEN_SLOTS in main.cpp
+#define PROBES       1000000    // Never-seen IDs looked up for the false-positive rate
+
+// Same FNV-1a 64 as eventIdHash() in main.cpp
+static uint64_t idHash(const char* id) {
+    uint64_t h = 14695981039346656037ULL;
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// USGS-style IDs; the salt keeps probe IDs apart from the live ones
+static void makeId(char* buf, size_t len, const char* salt, uint32_t n) {
+    snprintf(buf, len, "USGS:%sus7000%05x", salt, n);
+}
+
+// ----- The old implementation, as it was -----
+
+#define OLD_MAX_EVENTS 20
+#define OLD_ID_LENGTH  24
+
+struct LinearSeen {
+    char ids[OLD_MAX_EVENTS][OLD_ID_LENGTH];
+    int  count;
+    int  index;
+
+    bool isSeen(const char* id) const {
+        for (int i = 0; i < count; i++) {
+            if (strcmp(ids[i], id) == 0) return true;
+        }
+        return false;
+    }
+
+    void mark(const char* id) {
+        strncpy(ids[index], id, OLD_ID_LENGTH - 1);
+        ids[index][OLD_ID_LENGTH - 1] = '\0';
+        index = (index + 1) % OLD_MAX_EVENTS;
+        if (count < OLD_MAX_EVENTS) count++;
+    }
+};
+
+static SeenTable<TABLE_SLOTS> table;
+static LinearSeen linear;
+
+void setUp() {
+    table.clear();
+    memset(&linear, 0, sizeof(linear));
+}
+
+void tearDown() {}
+
+static void fill(int n) {
+    char id[32];
+    for (int i = 0; i < n; i++) {
+        makeId(id, sizeof(id), "", i);
+        TEST_ASSERT_TRUE(table.set(SeenTable<TABLE_SLOTS>::fingerprint(idHash(id)), -1));
+        linear.mark(id);
+    }
+}
+
+// ----- Correctness -----
+
+void test_holds_several_hundred_ids() {
+    fill(LIVE_IDS);
+    TEST_ASSERT_EQUAL_INT(LIVE_IDS, table.count);
+
+    // Every live ID is still known; the old array only has the last 20
+    char id[32];
+    int tableMisses = 0, linearMisses = 0;
+    for (int i = 0; i < LIVE_IDS; i++) {
+        makeId(id, sizeof(id), "", i);
+        if (!table.contains(idHash(id), -1)) tableMisses++;
+        if (!linear.isSeen(id)) linearMisses++;
+    }
+    char msg[96];
+    snprintf(msg, sizeof(msg), "forgotten of %d live: table %d, old array %d",
+             LIVE_IDS, tableMisses, linearMisses);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL_INT(0, tableMisses);
+    TEST_ASSERT_EQUAL_INT(LIVE_IDS - OLD_MAX_EVENTS, linearMisses);
+}
+
+void test_expiry_keeps_probe_chains_intact() {
+    // Half the IDs expire at unit 10, the rest never; interleaved so the
+    // backward-shift deletes run through shared chains
+    char id[32];
+    for (int i = 0; i < LIVE_IDS; i++) {
+        makeId(id, sizeof(id), "", i);
+        uint32_t stamp = (i & 1) ? (10UL << 24) : 0;
+        TEST_ASSERT_TRUE(table.set(stamp | SeenTable<TABLE_SLOTS>::fingerprint(idHash(id)), 5));
+    }
+
+    TEST_ASSERT_EQUAL_INT(LIVE_IDS / 2, table.sweep(10));
+    TEST_ASSERT_EQUAL_INT(LIVE_IDS / 2, table.count);
+    for (int i = 0; i < LIVE_IDS; i++) {
+        makeId(id, sizeof(id), "", i);
+        TEST_ASSERT_EQUAL_INT(!(i & 1), table.contains(idHash(id), 10));
+    }
+}
+
+void test_evicts_soonest_expiry_first() {
+    table.set((20UL << 24) | 0x000101, 5);
+    table.set((7UL << 24) | 0x000202, 5);
+    table.set((30UL << 24) | 0x000303, 5);
+    table.evictSoonest(5);
+    TEST_ASSERT_EQUAL_INT(2, table.count);
+    TEST_ASSERT_EQUAL_INT(0, table.slots[table.probe(0x000202, 5)]);
+}
+
+// ----- Benchmark -----
+
+void test_false_positive_rate() {
+    fill(LIVE_IDS);
+
+    // The 16-bit alternative: same hash, folded to 16 bits
+    std::set<uint16_t> fp16;
+    char id[32];
+    for (int i = 0; i < LIVE_IDS; i++) {
+        makeId(id, sizeof(id), "", i);
+        uint64_t h = idHash(id);
+        fp16.insert((uint16_t)(h ^ (h >> 16) ^ (h >> 32) ^ (h >> 48)));
+    }
+
+    uint32_t hits24 = 0, hits16 = 0, hitsOld = 0;
+    for (uint32_t i = 0; i < PROBES; i++) {
+        makeId(id, sizeof(id), "new", i);
+        uint64_t h = idHash(id);
+        if (table.contains(h, -1)) hits24++;
+        if (fp16.count((uint16_t)(h ^ (h >> 16) ^ (h >> 32) ^ (h >> 48)))) hits16++;
+        if (i < PROBES / 100 && linear.isSeen(id)) hitsOld++;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "false positives with %d live IDs: 24-bit %u/%u, 16-bit %u/%u, old array %u/%u",
+             LIVE_IDS, hits24, PROBES, hits16, PROBES, hitsOld, PROBES / 100);
+    TEST_MESSAGE(msg);
+
+    // Expected 300 / 2^24 = 1.8e-5 and 300 / 2^16 = 4.6e-3
+    TEST_ASSERT_LESS_THAN(PROBES / 10000, hits24);      // < 1e-4
+    TEST_ASSERT_GREATER_THAN(PROBES / 1000, hits16);    // > 1e-3 - why slots stay 32-bit
+    TEST_ASSERT_EQUAL_INT(0, hitsOld);
+}
+
+template <typename F>
+static double nsPerLookup(int rounds, F lookup) {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t found = 0;
+    for (int r = 0; r < rounds; r++) found += lookup(r);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(found <= (uint32_t)rounds);    // Keeps the loop from being optimized away
+    return (double)ns / rounds;
+}
+
+void test_lookup_cost() {
+    // Half hits, half misses - what a poll of a busy feed looks like
+    static char ids[2 * LIVE_IDS][32];
+    for (int i = 0; i < 2 * LIVE_IDS; i++) makeId(ids[i], sizeof(ids[i]), "", i);
+    fill(LIVE_IDS);
+
+    // The old array as it was (20 IDs), and grown to hold as many as the table
+    static LinearSeen big[LIVE_IDS / OLD_MAX_EVENTS];
+    memset(big, 0, sizeof(big));
+    for (int i = 0; i < LIVE_IDS; i++) big[i / OLD_MAX_EVENTS].mark(ids[i]);
+
+    const int rounds = 200000;
+    double tableNs = nsPerLookup(rounds, [](int r) {
+        return (uint32_t)table.contains(idHash(ids[r % (2 * LIVE_IDS)]), -1);
+    });
+    double oldNs = nsPerLookup(rounds, [](int r) {
+        return (uint32_t)linear.isSeen(ids[r % (2 * LIVE_IDS)]);
+    });
+    double bigNs = nsPerLookup(rounds, [](int r) {
+        for (auto& part : big) {
+            if (part.isSeen(ids[r % (2 * LIVE_IDS)])) return 1u;
+        }
+        return 0u;
+    });
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "ns per lookup: table (%d IDs) %.1f, old array (20 IDs) %.1f, linear scan of %d IDs %.1f",
+             LIVE_IDS, tableNs, oldNs, LIVE_IDS, bigNs);
+    TEST_MESSAGE(msg);
+
+    // Hashing is O(1) - scanning as many IDs as the table holds is not
+    TEST_ASSERT_TRUE(tableNs < bigNs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_holds_several_hundred_ids);
+    RUN_TEST(test_expiry_keeps_probe_chains_intact);
+    RUN_TEST(test_evicts_soonest_expiry_first);
+    RUN_TEST(test_false_positive_rate);
+    RUN_TEST(test_lookup_cost);
+    return UNITY_END();
+}
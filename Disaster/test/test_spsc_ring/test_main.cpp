@@ -0,0 +1,118 @@
+// SpscRing: single-thread behaviour, then a producer and a consumer thread
+// pushing a long numbered run through a small ring - nothing may be lost,
+// duplicated or reordered. Run with: pio test -e native -v
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include "spsc_ring.h"
+
+#define STRESS_COUNT  2000000UL
+
+// Payload wider than one word, so a torn copy shows up as a mismatch
+struct Item {
+    uint32_t seq;
+    uint32_t check;
+};
+
+static uint32_t checkOf(uint32_t seq) { return seq * 2654435761UL ^ 0xA5A5A5A5UL; }
+
+void setUp() {}
+void tearDown() {}
+
+// ----- Single thread -----
+
+void test_fill_and_drain() {
+    SpscRing<int, 5> ring;
+    TEST_ASSERT_TRUE(ring.empty());
+    for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_TRUE(ring.full());
+    TEST_ASSERT_FALSE(ring.push(99));
+    TEST_ASSERT_EQUAL_INT(5, (int)ring.size());
+
+    TEST_ASSERT_EQUAL_INT(0, *ring.peek());
+    TEST_ASSERT_EQUAL_INT(4, *ring.peek(4));
+    TEST_ASSERT_NULL(ring.peek(5));
+
+    int v;
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(ring.pop(v));
+        TEST_ASSERT_EQUAL_INT(i, v);
+    }
+    TEST_ASSERT_FALSE(ring.pop(v));
+}
+
+void test_wraps_around() {
+    SpscRing<int, 3> ring;
+    int v;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_TRUE(ring.push(i + 1000));
+        TEST_ASSERT_TRUE(ring.pop(v));
+        TEST_ASSERT_EQUAL_INT(i, v);
+        TEST_ASSERT_TRUE(ring.drop());
+        TEST_ASSERT_TRUE(ring.empty());
+    }
+    ring.push(1);
+    ring.push(2);
+    ring.clear();
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+// ----- Two threads -----
+
+// Consumer: every item must be the next number, intact
+static void runStress(uint32_t count) {
+    static SpscRing<Item, 7> ring;      // Small and odd-sized - wraps constantly
+    uint32_t pushFails = 0;
+    std::atomic<bool> stop(false);      // Consumer gave up - don't spin on a full ring
+
+    std::thread producer([&]() {
+        for (uint32_t seq = 0; seq < count && !stop.load(); ) {
+            Item it = { seq, checkOf(seq) };
+            if (ring.push(it)) {
+                seq++;
+            } else {
+                pushFails++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0, bad = 0, torn = 0;
+    while (expected < count) {
+        Item it;
+        if (!ring.pop(it)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (it.seq != expected) bad++;
+        if (it.check != checkOf(it.seq)) torn++;
+        expected = it.seq + 1;
+        if (bad > 0) break;             // Lost or reordered - no point going on
+    }
+    stop.store(true);
+    producer.join();
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%u items through a 7-slot ring, producer found it full %u times",
+             count, pushFails);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_EQUAL_UINT32(0, bad);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(count, expected);
+    TEST_ASSERT_TRUE(ring.empty());     // Nothing duplicated after the last one
+}
+
+void test_two_threads_lose_nothing() {
+    runStress(STRESS_COUNT);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fill_and_drain);
+    RUN_TEST(test_wraps_around);
+    RUN_TEST(test_two_threads_lose_nothing);
+    return UNITY_END();
+}